@@ -0,0 +1,147 @@
+// ==================================================================================
+// PS_FORKSERVER - fork server shim for ps_tester (--fork-server)
+// ==================================================================================
+//
+// Preloaded into push_swap/checker, it stops the program right before main():
+// ld.so, relocations and libc init have already run once. The tester then
+// sends one request per test case over the control socket and every request
+// is served by a fork() that enters main() with the requested argv.
+//
+// Protocol (control socket on fd PS_FORKSERVER_FD, stream, native ints):
+//   server -> tester  "PSFS"                       once, when attached
+//   tester -> server  u32 length + 3 fds (SCM_RIGHTS), then `length` bytes
+//                     of NUL-terminated arguments (argv[1..])
+//   server -> tester  i32 pid                      child forked (-1: failed)
+//   server -> tester  i32 wait status              child exited
+//
+// Without PS_FORKSERVER_FD in the environment the shim does nothing.
+//
+// Build: make forkserver
+// ==================================================================================
+
+#define _GNU_SOURCE
+#include <dlfcn.h>
+#include <errno.h>
+#include <signal.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+typedef int (*main_fn)(int, char**, char**);
+typedef int (*start_main_fn)(main_fn, int, char**, void (*)(void), void (*)(void),
+                             void (*)(void), void*);
+
+static main_fn real_main;
+static int ctl_fd = -1;
+
+static int read_full(int fd, void* buf, size_t len) {
+    char* p = buf;
+    while (len > 0) {
+        ssize_t n = read(fd, p, len);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return -1;
+        p += n;
+        len -= n;
+    }
+    return 0;
+}
+
+static int write_full(int fd, const void* buf, size_t len) {
+    const char* p = buf;
+    while (len > 0) {
+        ssize_t n = write(fd, p, len);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return -1;
+        p += n;
+        len -= n;
+    }
+    return 0;
+}
+
+// Receives the request header and the child's stdin/stdout/stderr
+static int recv_request(uint32_t* len, int fds[3]) {
+    char cbuf[CMSG_SPACE(3 * sizeof(int))];
+    struct iovec iov = {len, sizeof(*len)};
+    struct msghdr msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = cbuf;
+    msg.msg_controllen = sizeof(cbuf);
+
+    ssize_t n;
+    do n = recvmsg(ctl_fd, &msg, MSG_CMSG_CLOEXEC);
+    while (n < 0 && errno == EINTR);
+    if (n != sizeof(*len)) return -1;
+
+    struct cmsghdr* cm = CMSG_FIRSTHDR(&msg);
+    if (!cm || cm->cmsg_type != SCM_RIGHTS || cm->cmsg_len != CMSG_LEN(3 * sizeof(int)))
+        return -1;
+    memcpy(fds, CMSG_DATA(cm), 3 * sizeof(int));
+    return 0;
+}
+
+static void run_child(char* prog, char* args, uint32_t len, int fds[3]) {
+    dup2(fds[0], STDIN_FILENO);
+    dup2(fds[1], STDOUT_FILENO);
+    dup2(fds[2], STDERR_FILENO);
+    close(ctl_fd);
+
+    int argc = 1;
+    for (uint32_t i = 0; i < len; ++i)
+        if (args[i] == '\0') argc++;
+    char** argv = malloc((argc + 1) * sizeof(char*));
+    if (!argv) _exit(127);
+    argv[0] = prog;
+    char* p = args;
+    for (int i = 1; i < argc; ++i) {
+        argv[i] = p;
+        p += strlen(p) + 1;
+    }
+    argv[argc] = NULL;
+    exit(real_main(argc, argv, environ));
+}
+
+// Stands in for main(): serve requests until the tester hangs up
+static int serve(int argc, char** argv, char** envp) {
+    (void)argc;
+    (void)envp;
+    unsetenv("LD_PRELOAD");
+    unsetenv("PS_FORKSERVER_FD");
+
+    if (write_full(ctl_fd, "PSFS", 4) < 0) _exit(1);
+    for (;;) {
+        uint32_t len;
+        int fds[3];
+        if (recv_request(&len, fds) < 0) _exit(0);
+        char* args = malloc(len + 1);
+        if (!args || read_full(ctl_fd, args, len) < 0) _exit(1);
+        args[len] = '\0';
+
+        int32_t pid = fork();
+        if (pid == 0) run_child(argv[0], args, len, fds);
+        free(args);
+        for (int i = 0; i < 3; ++i) close(fds[i]);
+        if (write_full(ctl_fd, &pid, sizeof(pid)) < 0) _exit(1);
+        if (pid < 0) continue;
+
+        int32_t status = 0;
+        while (waitpid(pid, &status, 0) < 0 && errno == EINTR) {}
+        if (write_full(ctl_fd, &status, sizeof(status)) < 0) _exit(1);
+    }
+}
+
+int __libc_start_main(main_fn main, int argc, char** argv, void (*init)(void),
+                      void (*fini)(void), void (*rtld_fini)(void), void* stack_end) {
+    start_main_fn real_start = (start_main_fn)dlsym(RTLD_NEXT, "__libc_start_main");
+    const char* fd = getenv("PS_FORKSERVER_FD");
+    if (fd) {
+        ctl_fd = atoi(fd);
+        real_main = main;
+        main = serve;
+    }
+    return real_start(main, argc, argv, init, fini, rtld_fini, stack_end);
+}
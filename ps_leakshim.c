@@ -0,0 +1,217 @@
+// ==================================================================================
+// PS_LEAKSHIM - allocation tracker for ps_tester (--leak-engine=shim)
+// ==================================================================================
+//
+// Preloaded into push_swap/checker, it interposes malloc/calloc/realloc/free
+// and records every live block in a lock-free open-addressing table, the
+// ones libc allocates on the program's behalf (strdup, getline, ...)
+// included. At exit the data/bss and thread-local blocks of every loaded
+// object and the live stack are scanned for pointers to those blocks, the
+// same way valgrind tells "still reachable" from "definitely lost": libc's
+// own buffers hang off libc's globals and stay reachable. One line is
+// written to the fd in PS_LEAKSHIM_FD:
+//
+//   PSLEAK <lost bytes> <lost blocks> <allocations> <peak heap bytes>
+//
+// Without PS_LEAKSHIM_FD in the environment nothing is reported.
+//
+// Build: make leakshim
+// ==================================================================================
+
+#define _GNU_SOURCE
+#include <link.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+extern void* __libc_malloc(size_t);
+extern void* __libc_calloc(size_t, size_t);
+extern void* __libc_realloc(void*, size_t);
+extern void __libc_free(void*);
+extern void* __libc_stack_end;
+
+#define TABLE_BITS 20
+#define TABLE_SIZE ((size_t)1 << TABLE_BITS)
+#define EMPTY 0
+#define TOMBSTONE 1
+#define MAX_ROOTS 256
+
+typedef struct {
+    _Atomic uintptr_t key;
+    size_t size;
+    int reachable;
+} slot_t;
+
+static slot_t* table;
+static _Atomic int table_full;  // a block couldn't be recorded: report is partial
+static _Atomic size_t alloc_count;
+static _Atomic size_t heap_bytes;
+static _Atomic size_t peak_bytes;
+static uintptr_t root_start[MAX_ROOTS], root_end[MAX_ROOTS];
+static int root_count;
+
+static size_t hash_ptr(uintptr_t p) {
+    p ^= p >> 33;
+    p *= 0xff51afd7ed558ccdULL;
+    p ^= p >> 33;
+    return (size_t)p & (TABLE_SIZE - 1);
+}
+
+static void add_root(uintptr_t lo, uintptr_t hi) {
+    if (root_count == MAX_ROOTS) {
+        atomic_store(&table_full, 1);  // unscanned roots: blocks may look lost
+        return;
+    }
+    root_start[root_count] = lo;
+    root_end[root_count] = hi;
+    root_count++;
+}
+
+// Writable segments and this thread's TLS block of every loaded object,
+// the program's, libc's and ld.so's alike
+static int find_roots(struct dl_phdr_info* info, size_t size, void* data) {
+    (void)size;
+    (void)data;
+    for (int i = 0; i < info->dlpi_phnum; ++i) {
+        const ElfW(Phdr)* ph = &info->dlpi_phdr[i];
+        if (ph->p_type == PT_LOAD && (ph->p_flags & PF_W)) {
+            uintptr_t lo = info->dlpi_addr + ph->p_vaddr;
+            add_root(lo, lo + ph->p_memsz);
+        } else if (ph->p_type == PT_TLS && info->dlpi_tls_data) {
+            uintptr_t lo = (uintptr_t)info->dlpi_tls_data;
+            add_root(lo, lo + ph->p_memsz);
+        }
+    }
+    return 0;
+}
+
+__attribute__((constructor)) static void shim_init(void) {
+    table = mmap(NULL, TABLE_SIZE * sizeof(slot_t), PROT_READ | PROT_WRITE,
+                 MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if (table == MAP_FAILED) table = NULL;
+}
+
+static void track(void* p, size_t size) {
+    if (!table) return;
+    atomic_fetch_add(&alloc_count, 1);
+    size_t i = hash_ptr((uintptr_t)p);
+    for (size_t n = 0; n < TABLE_SIZE; ++n, i = (i + 1) & (TABLE_SIZE - 1)) {
+        uintptr_t k = atomic_load_explicit(&table[i].key, memory_order_relaxed);
+        if ((k == EMPTY || k == TOMBSTONE) &&
+            atomic_compare_exchange_strong(&table[i].key, &k, (uintptr_t)p)) {
+            table[i].size = size;
+            size_t now = atomic_fetch_add(&heap_bytes, size) + size;
+            size_t peak = atomic_load(&peak_bytes);
+            while (now > peak && !atomic_compare_exchange_weak(&peak_bytes, &peak, now)) {}
+            return;
+        }
+    }
+    atomic_store(&table_full, 1);
+}
+
+// Forgets `p` if it was tracked
+static void untrack(void* p) {
+    if (!table || !p) return;
+    size_t i = hash_ptr((uintptr_t)p);
+    for (size_t n = 0; n < TABLE_SIZE; ++n, i = (i + 1) & (TABLE_SIZE - 1)) {
+        uintptr_t k = atomic_load_explicit(&table[i].key, memory_order_acquire);
+        if (k == EMPTY) return;
+        if (k == (uintptr_t)p) {
+            atomic_fetch_sub(&heap_bytes, table[i].size);
+            atomic_store(&table[i].key, TOMBSTONE);
+            return;
+        }
+    }
+}
+
+static slot_t* lookup(uintptr_t p) {
+    if (p <= TOMBSTONE) return NULL;
+    size_t i = hash_ptr(p);
+    for (size_t n = 0; n < TABLE_SIZE; ++n, i = (i + 1) & (TABLE_SIZE - 1)) {
+        uintptr_t k = atomic_load_explicit(&table[i].key, memory_order_relaxed);
+        if (k == EMPTY) return NULL;
+        if (k == p) return &table[i];
+    }
+    return NULL;
+}
+
+void* malloc(size_t size) {
+    void* p = __libc_malloc(size);
+    if (p) track(p, size);
+    return p;
+}
+
+void* calloc(size_t n, size_t size) {
+    void* p = __libc_calloc(n, size);
+    if (p) track(p, n * size);
+    return p;
+}
+
+void* realloc(void* old, size_t size) {
+    void* p = __libc_realloc(old, size);
+    if (!p && size) return NULL;  // old block untouched
+    untrack(old);
+    if (p) track(p, size);
+    return p;
+}
+
+void free(void* p) {
+    untrack(p);
+    __libc_free(p);
+}
+
+// Marks every tracked block a word in [lo, hi) points to, then everything
+// reachable from those blocks
+static void scan(uintptr_t lo, uintptr_t hi, uintptr_t* stack, size_t* depth, size_t cap) {
+    lo = (lo + sizeof(uintptr_t) - 1) & ~(uintptr_t)(sizeof(uintptr_t) - 1);
+    for (uintptr_t a = lo; a + sizeof(uintptr_t) <= hi; a += sizeof(uintptr_t)) {
+        slot_t* s = lookup(*(uintptr_t*)a);
+        if (s && !s->reachable) {
+            s->reachable = 1;
+            if (*depth < cap) stack[(*depth)++] = (uintptr_t)(s - table);
+        }
+    }
+}
+
+__attribute__((destructor)) static void shim_report(void) {
+    const char* fd_str = getenv("PS_LEAKSHIM_FD");
+    if (!fd_str || !table) return;
+    int fd = atoi(fd_str);
+
+    // Worklist of slot indexes, outside the tracked heap
+    size_t cap = TABLE_SIZE;
+    uintptr_t* work = mmap(NULL, cap * sizeof(uintptr_t), PROT_READ | PROT_WRITE,
+                           MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if (work != MAP_FAILED) {
+        size_t depth = 0;
+        dl_iterate_phdr(find_roots, NULL);
+        for (int i = 0; i < root_count; ++i) scan(root_start[i], root_end[i], work, &depth, cap);
+        uintptr_t sp = (uintptr_t)__builtin_frame_address(0);
+        scan(sp, (uintptr_t)__libc_stack_end, work, &depth, cap);
+        while (depth > 0) {
+            slot_t* s = &table[work[--depth]];
+            uintptr_t base = atomic_load(&s->key);
+            scan(base, base + s->size, work, &depth, cap);
+        }
+        munmap(work, cap * sizeof(uintptr_t));
+    }
+
+    size_t lost_bytes = 0, lost_blocks = 0;
+    for (size_t i = 0; i < TABLE_SIZE; ++i) {
+        uintptr_t k = atomic_load(&table[i].key);
+        if (k > TOMBSTONE && !table[i].reachable) {
+            lost_bytes += table[i].size;
+            lost_blocks++;
+        }
+    }
+
+    char line[128];
+    int len = snprintf(line, sizeof(line), "PSLEAK %zu %zu %zu %zu%s\n", lost_bytes, lost_blocks,
+                       atomic_load(&alloc_count), atomic_load(&peak_bytes),
+                       atomic_load(&table_full) ? " partial" : "");
+    if (len > 0) write(fd, line, len);
+}
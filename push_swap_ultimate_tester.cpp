@@ -22,6 +22,31 @@
 //   --stress          Extra stress tests
 //   --html            Generate HTML report
 //   --checker-only    Only test checker program
+//   -j, --jobs N      Run test cases on N workers ("auto" = one per core)
+//   --max-output SIZE Per-stream capture cap for child output (default 64M)
+//   --spawn MODE      Child launch backend: posix_spawn (default) or fork
+//   --spawn-bench N   Measure spawns/sec of both backends and exit
+//   --sim-bench N     Compare the stack simulators on N numbers and exit
+//   --fork-server     Fork test runs from a preloaded server (make forkserver)
+//   --early-kill      Stop push_swap at its first invalid op or once hopeless
+//   --seed N          Reproduce a previous run's random inputs
+//   --leak-sample P%|K Benchmark runs re-checked under valgrind (default 10%)
+//   --leak-engine E   Leak checker: valgrind (default) or shim (make leakshim)
+//   --mem-budget SIZE Peak RSS allowed for parallel valgrind jobs (default RAM/2)
+//   --cache-dir DIR   Where run results are cached (default .ps_tester_cache)
+//   --no-cache        Don't read or write the on-disk result cache
+//   --adaptive[=STAT] Benchmark until the grade is settled (STAT: mean, pNN)
+//   --max-iter N      Cap on adaptive benchmark runs per size (default 1000)
+//   --tail-risk[=N]   Run N samples of 100/500 and report P(ops > limit)
+//   --trials K        Evaluation size for the tail-risk pass chance (default 5)
+//   --scaling         Time push_swap on n = 3 … 100000, fit its growth and exit
+//   --json FILE       Write one JSON line per test as it completes
+//   --junit FILE      Write JUnit XML for CI dashboards, as tests complete
+//   --history FILE    Benchmark history file (default .ps_tester_history.csv)
+//   --no-history      Don't append this run to the history
+//   --baseline RUN    Rerun a past run's inputs, exit 2 if ops regressed
+//   --tolerance PCT   Regression allowed against the baseline (default 1%)
+//   --compare A B     Run two push_swap builds on the same inputs, compare and exit
 // ==================================================================================
 
 #include <iostream>
@@ -31,6 +56,7 @@
 #include <algorithm>
 #include <random>
 #include <unordered_set>
+#include <unordered_map>
 #include <set>
 #include <map>
 #include <fstream>
@@ -42,14 +68,26 @@
 #include <unistd.h>
 #include <signal.h>
 #include <climits>
+#include <cmath>
 #include <numeric>
 #include <chrono>
 #include <thread>
 #include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <memory>
 #include <atomic>
 #include <deque>
 #include <fcntl.h>
+#include <poll.h>
+#include <spawn.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <cerrno>
 #include <ctime>
+#ifdef __linux__
+#include <sys/syscall.h>
+#endif
 
 using namespace std;
 
@@ -90,9 +128,31 @@ struct Config {
     bool checker_only = false;
     bool verbose = false;
     int timeout_sec = 5;
+    int jobs = 1;
+    size_t max_output = 64u << 20;  // bytes kept per child stream
+    bool use_fork = false;          // fork()+execvp() instead of posix_spawn()
+    bool early_kill = false;        // stop runs at an invalid op / over budget
+    uint64_t seed = 0;              // run seed, every random input derives from it
+    double leak_sample_pct = 10;    // share of benchmark runs repeated under valgrind
+    int leak_sample_first = -1;     // or the first K per size when >= 0
+    string fork_server;             // preload shim path, empty = off
+    string leak_shim;               // --leak-engine=shim tracker path, empty = valgrind
+    size_t mem_budget = 0;          // RSS cap for parallel valgrind jobs, 0 = half of RAM
+    string cache_dir = ".ps_tester_cache";  // on-disk result cache, empty = off
+    double adaptive_q = 0;          // --adaptive: 0 = off, -1 = mean, else the quantile
+    int max_iterations = 1000;      // cap on adaptive benchmark runs per size
+    int tail_samples = 0;           // --tail-risk: runs of 100/500, 0 = off
+    int eval_trials = 5;            // random inputs in an evaluation, for the pass chance
     string trace_file = "trace.log";
     string html_file = "report.html";
     string errors_file = "errors.txt";
+    string spill_file = "failed_outputs.txt";
+    string json_file;               // --json: one JSON line per test, empty = off
+    string junit_file;              // --junit: JUnit XML, empty = off
+    string history_file = ".ps_tester_history.csv";  // benchmark results of past runs
+    bool record_history = true;     // append this run's benchmarks to it
+    string baseline;                // --baseline: run to compare against, empty = off
+    double tolerance_pct = 1;       // regression allowed before --baseline fails
 };
 
 Config cfg;
@@ -118,6 +178,34 @@ const vector<Threshold> SCORES_500 = {
 // ==================================================================================
 // Statistics
 // ==================================================================================
+// Counters are only touched from TaskPool commit callbacks, which run one at
+// a time in submission order, so they need no locking of their own.
+struct ExecResult;
+
+// Children's resource usage summed over a benchmark size (runs whose rusage
+// is known: not the fork server's)
+struct UsageTotals {
+    int runs = 0;
+    double user_ms = 0;
+    double sys_ms = 0;
+    size_t max_rss = 0;             // largest of the runs
+    bool max_rss_bound = false;     // that largest is only an upper bound
+    long long minor_faults = 0;
+    long long major_faults = 0;
+    long long vol_switches = 0;
+    long long invol_switches = 0;
+    
+    void add(const ExecResult& r);
+};
+
+// One size's benchmark as kept in the history file: op count by input
+// index (-1 = the run failed) and the average time of the runs that sorted
+struct PerfRun {
+    vector<int> ops;
+    double wall_ms = 0;
+    double cpu_ms = 0;
+};
+
 struct Stats {
     int total = 0;
     int passed = 0;
@@ -127,6 +215,8 @@ struct Stats {
     int timeouts = 0;
     vector<string> failed_tests;
     map<string, vector<int>> perf_results;
+    map<string, UsageTotals> perf_usage;
+    map<int, PerfRun> perf_runs;
 };
 
 struct CheckerStats {
@@ -140,7 +230,6 @@ struct CheckerStats {
 
 Stats stats;
 CheckerStats checker_stats;
-mutex stats_mutex;
 
 // ==================================================================================
 // Test Result Structure
@@ -152,16 +241,48 @@ struct ExecResult {
     int signal_num = 0;
     bool timed_out = false;
     double exec_time_ms = 0;
+    bool output_truncated = false;  // a stream hit cfg.max_output, child was killed
+    bool aborted = false;           // the stdout sink gave up, child was killed
     
-    // Valgrind specific
+    // Leak check specific (valgrind or the leak shim)
     bool has_leaks = false;
-    int leaked_bytes = 0;
-    int leaked_blocks = 0;
+    int64_t leaked_bytes = 0;       // definitely lost
+    int64_t leaked_blocks = 0;
+    int64_t indirect_bytes = 0;     // valgrind only, like the three below
+    int64_t possible_bytes = 0;
+    int64_t reachable_bytes = 0;
+    int invalid_reads = 0;
+    int invalid_writes = 0;
     bool has_errors = false;
     int error_count = 0;
-    string valgrind_summary;
+    long long alloc_count = 0;      // shim only: allocations, libc's included
+    long long peak_heap = 0;        // shim only: peak bytes live at once
+    string leak_summary;
+    size_t max_rss = 0;             // child's peak RSS in bytes (wait4), 0 if unknown
+    bool max_rss_bound = false;     // the program stayed below this, see reap in execute_argv
+    double user_ms = 0;             // child's CPU time (wait4), 0 if unknown
+    double sys_ms = 0;
+    long minor_faults = 0;          // rest of the child's rusage, same source
+    long major_faults = 0;
+    long vol_switches = 0;
+    long invol_switches = 0;
 };
 
+void UsageTotals::add(const ExecResult& r) {
+    if (r.max_rss == 0) return;
+    runs++;
+    user_ms += r.user_ms;
+    sys_ms += r.sys_ms;
+    if (r.max_rss > max_rss || (r.max_rss == max_rss && !r.max_rss_bound)) {
+        max_rss = r.max_rss;
+        max_rss_bound = r.max_rss_bound;
+    }
+    minor_faults += r.minor_faults;
+    major_faults += r.major_faults;
+    vol_switches += r.vol_switches;
+    invol_switches += r.invol_switches;
+}
+
 struct TestResult {
     string name;
     string category;
@@ -170,420 +291,2655 @@ struct TestResult {
     string details;
     ExecResult exec;
     int instruction_count = 0;
+    int64_t spill_offset = -1;      // where spill_output() put the outputs
+    uint32_t spill_size = 0;
+    uint64_t seed = 0;              // what generated the input, if anything
+};
+
+// What's kept of a test once it's committed: the outputs themselves are
+// dropped, a failing test's go to the spill file first
+struct ResultRecord {
+    string name;
+    string category;
+    string status;
+    string details;
+    bool passed = false;
+    bool timed_out = false;
+    int instruction_count = 0;
+    int exit_code = 0;
+    int signal_num = 0;
+    double exec_time_ms = 0;
+    double user_ms = 0;
+    double sys_ms = 0;
+    size_t max_rss = 0;
+    bool max_rss_bound = false;
+    int64_t leaked_bytes = 0;
+    uint64_t output_digest = 0;     // FNV-1a of the captured stdout + stderr
+    int64_t spill_offset = -1;      // -1: nothing spilled
+    uint32_t spill_size = 0;
 };
 
-vector<TestResult> all_results;
+vector<ResultRecord> all_results;
 
-// ==================================================================================
-// Utility Functions
-// ==================================================================================
+using TestHandle = shared_ptr<TestResult>;
 
-void log_trace(const string& name, const vector<string>& args, const string& extra = "") {
-    lock_guard<mutex> lock(stats_mutex);
-    ofstream f(cfg.trace_file, ios::app);
-    auto now = chrono::system_clock::now();
-    time_t t = chrono::system_clock::to_time_t(now);
-    f << "[" << put_time(localtime(&t), "%H:%M:%S") << "] " << name << "\n";
+// Failing tests' outputs, appended to cfg.spill_file and read back by
+// offset. Only touched from commits, which run one at a time.
+class SpillFile {
+public:
+    // Appends one block, returns its offset or -1
+    int64_t append(const string& block) {
+        if (fd < 0) {
+            fd = open(cfg.spill_file.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+            if (fd < 0) return -1;
+        }
+        int64_t at = end;
+        const char* p = block.data();
+        size_t left = block.size();
+        while (left > 0) {
+            ssize_t n = pwrite(fd, p, left, end);
+            if (n < 0 && errno == EINTR) continue;
+            if (n <= 0) return -1;
+            p += n;
+            left -= n;
+            end += n;
+        }
+        return at;
+    }
     
-    // Show actual command with valgrind if enabled
-    if (cfg.use_valgrind) {
-        f << "  Command: valgrind --leak-check=full " << cfg.push_swap;
-    } else {
-        f << "  Command: " << cfg.push_swap;
-    }
-    for (const auto& s : args) f << " \"" << s << "\"";
-    f << "\n";
-    if (!extra.empty()) f << "  Details: " << extra << "\n";
-    f << "\n";
-}
-
-void log_error(const string& test_name, const string& category, const string& details, const vector<string>& args = {}) {
-    lock_guard<mutex> lock(stats_mutex);
-    ofstream f(cfg.errors_file, ios::app);
-    f << "━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━\n";
-    f << "FAILED: " << test_name << "\n";
-    f << "Category: " << category << "\n";
-    if (!args.empty()) {
-        f << "Input: ";
-        for (size_t i = 0; i < args.size() && i < 20; ++i) {
-            f << args[i];
-            if (i < args.size() - 1) f << " ";
-        }
-        if (args.size() > 20) f << "... (" << args.size() << " total)";
-        f << "\n";
+    string load(int64_t offset, uint32_t size) const {
+        if (fd < 0 || offset < 0) return "";
+        string out(size, '\0');
+        size_t got = 0;
+        while (got < size) {
+            ssize_t n = pread(fd, &out[got], size - got, offset + got);
+            if (n < 0 && errno == EINTR) continue;
+            if (n <= 0) break;
+            got += n;
+        }
+        out.resize(got);
+        return out;
     }
-    if (!details.empty()) f << "Reason: " << details << "\n";
-    f << "\n";
-}
 
-string vec_to_args(const vector<int>& v) {
-    string s;
-    for (size_t i = 0; i < v.size(); ++i) {
-        if (i > 0) s += " ";
-        s += to_string(v[i]);
-    }
-    return s;
-}
+private:
+    int fd = -1;
+    int64_t end = 0;
+};
 
-vector<string> split_string(const string& s) {
-    vector<string> result;
-    istringstream iss(s);
-    string token;
-    while (iss >> token) result.push_back(token);
-    return result;
-}
+SpillFile spill;
 
-int count_instructions(const string& output) {
-    if (output.empty()) return 0;
-    int count = 0;
-    for (char c : output) if (c == '\n') count++;
-    if (!output.empty() && output.back() != '\n') count++;
-    return count;
+// Writes a failing run's outputs to the spill file; the returned reference
+// goes in errors.txt, `offset` and `size` locate the entry (-1 if none)
+string spill_output(const string& name, const ExecResult& r, int64_t& offset, uint32_t& size) {
+    if (r.stdout_data.empty() && r.stderr_data.empty() && r.leak_summary.empty()) return "";
+    ostringstream block;
+    block << "=== " << name << "\n";
+    block << "--- stdout (" << r.stdout_data.size() << " bytes)\n" << r.stdout_data;
+    if (!r.stdout_data.empty() && r.stdout_data.back() != '\n') block << "\n";
+    block << "--- stderr (" << r.stderr_data.size() << " bytes)\n" << r.stderr_data;
+    if (!r.stderr_data.empty() && r.stderr_data.back() != '\n') block << "\n";
+    if (!r.leak_summary.empty()) block << "--- leak check\n" << r.leak_summary << "\n";
+    string s = block.str();
+    offset = spill.append(s);
+    if (offset < 0) return "";
+    size = s.size();
+    return "\n    Output: " + cfg.spill_file + " at byte " + to_string(offset);
 }
 
-bool is_valid_instruction(const string& instr) {
-    static const set<string> valid_ops = {
-        "sa", "sb", "ss", "pa", "pb", "ra", "rb", "rr", "rra", "rrb", "rrr"
-    };
-    return valid_ops.count(instr) > 0;
+string spill_output(TestResult& t) {
+    return spill_output(t.name, t.exec, t.spill_offset, t.spill_size);
 }
 
-bool validate_all_instructions(const string& output) {
-    if (output.empty()) return true;
-    istringstream iss(output);
-    string line;
-    while (getline(iss, line)) {
-        if (line.empty()) continue;
-        if (!is_valid_instruction(line)) return false;
+// The run's part of a record
+ResultRecord make_record(const string& name, const string& category, const ExecResult& r) {
+    ResultRecord rec;
+    rec.name = name;
+    rec.category = category;
+    rec.timed_out = r.timed_out;
+    rec.exit_code = r.exit_code;
+    rec.signal_num = r.signal_num;
+    rec.exec_time_ms = r.exec_time_ms;
+    rec.user_ms = r.user_ms;
+    rec.sys_ms = r.sys_ms;
+    rec.max_rss = r.max_rss;
+    rec.max_rss_bound = r.max_rss_bound;
+    rec.leaked_bytes = r.leaked_bytes;
+    uint64_t h = 1469598103934665603ULL;
+    for (const string* s : {&r.stdout_data, &r.stderr_data}) {
+        for (unsigned char c : *s) {
+            h ^= c;
+            h *= 1099511628211ULL;
+        }
     }
-    return true;
+    rec.output_digest = h;
+    return rec;
 }
 
-string get_grade(int avg, const vector<Threshold>& thresholds) {
-    for (const auto& t : thresholds) {
-        if (avg <= t.limit) return t.grade;
+// ==================================================================================
+// Result Streams (--json, --junit)
+// ==================================================================================
+
+// Control characters other than tab and newlines aren't allowed in XML at
+// all, not even escaped: they become '?'
+string xml_escape(const string& s) {
+    string out;
+    for (char c : s) {
+        switch (c) {
+            case '<': out += "&lt;"; break;
+            case '>': out += "&gt;"; break;
+            case '&': out += "&amp;"; break;
+            case '"': out += "&quot;"; break;
+            case '\t': case '\n': case '\r': out += c; break;
+            default: out += ((unsigned char)c < 0x20) ? '?' : c;
+        }
     }
-    return "0/5";
+    return out;
 }
 
-int get_score(int avg, const vector<Threshold>& thresholds) {
-    for (const auto& t : thresholds) {
-        if (avg <= t.limit) return t.score;
+string json_escape(const string& s) {
+    string out;
+    for (unsigned char c : s) {
+        if (c == '"' || c == '\\') {
+            out += '\\';
+            out += c;
+        } else if (c == '\n') {
+            out += "\\n";
+        } else if (c < 0x20) {
+            char esc[8];
+            snprintf(esc, sizeof(esc), "\\u%04x", c);
+            out += esc;
+        } else {
+            out += c;
+        }
     }
-    return 0;
+    return out;
 }
 
-// ==================================================================================
-// Number Generators
-// ==================================================================================
+// One word for CI: pass, fail, leak, timeout or crash
+const char* plain_status(const ResultRecord& r) {
+    if (r.passed) return "pass";
+    if (r.timed_out) return "timeout";
+    if (r.signal_num != 0) return "crash";
+    if (r.leaked_bytes > 0) return "leak";
+    return "fail";
+}
 
-vector<int> generate_unique_random(int n, int min_val = INT_MIN, int max_val = INT_MAX) {
-    vector<int> result;
-    unordered_set<int> used;
-    random_device rd;
-    mt19937 gen(rd());
-    uniform_int_distribution<int> dist(min_val, max_val);
+// Every test as it commits, as a JSON line and a JUnit <testcase>. Each
+// record is written whole as soon as it's emitted, so a killed or
+// interrupted run leaves complete lines; the JUnit footer is rewritten
+// after the last case every time and the counts in the header (fixed
+// width) updated, so the file is always a valid document. A few syscalls
+// per test, next to a process spawn each. Only touched from commits.
+class ResultStreams {
+public:
+    bool open(const string& json_path, const string& junit_path) {
+        if (!json_path.empty()) {
+            json.fd = ::open(json_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+            if (json.fd < 0) return false;
+        }
+        if (!junit_path.empty()) {
+            junit.fd = ::open(junit_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+            if (junit.fd < 0) return false;
+            junit.end = junit_header().size();
+            flush();
+        }
+        return true;
+    }
+    
+    bool active() const { return json.fd >= 0 || junit.fd >= 0; }
     
-    while (result.size() < (size_t)n) {
-        int val = dist(gen);
-        if (used.insert(val).second) {
-            result.push_back(val);
+    void emit(const ResultRecord& r, uint64_t seed) {
+        if (!active()) return;
+        const char* status = plain_status(r);
+        tests++;
+        if (!r.passed && (r.timed_out || r.signal_num != 0)) errors++;
+        else if (!r.passed) failures++;
+        
+        if (json.fd >= 0) {
+            ostringstream j;
+            j << fixed << setprecision(3);
+            j << "{\"name\":\"" << json_escape(r.name) << "\",\"category\":\"" << json_escape(r.category)
+              << "\",\"status\":\"" << status << "\",\"ops\":" << r.instruction_count
+              << ",\"time_ms\":" << r.exec_time_ms << ",\"user_ms\":" << r.user_ms << ",\"sys_ms\":" << r.sys_ms
+              << ",\"max_rss\":" << r.max_rss << ",\"max_rss_bound\":" << (r.max_rss_bound ? "true" : "false")
+              << ",\"leaked_bytes\":" << r.leaked_bytes
+              << ",\"exit_code\":" << r.exit_code << ",\"signal\":" << r.signal_num
+              << ",\"seed\":\"" << seed << "\",\"details\":\"" << json_escape(r.details) << "\"}\n";
+            json.buf += j.str();
+        }
+        if (junit.fd >= 0) {
+            ostringstream x;
+            x << fixed << setprecision(3);
+            x << "    <testcase classname=\"" << xml_escape(r.category) << "\" name=\"" << xml_escape(r.name)
+              << "\" time=\"" << r.exec_time_ms / 1000 << "\">\n";
+            if (!r.passed) {
+                const char* tag = (r.timed_out || r.signal_num != 0) ? "error" : "failure";
+                x << "      <" << tag << " type=\"" << status << "\" message=\"" << xml_escape(r.details) << "\"/>\n";
+            }
+            x << "      <system-out>ops=" << r.instruction_count << " seed=" << seed << "</system-out>\n";
+            x << "    </testcase>\n";
+            junit.buf += x.str();
+        }
+        flush();
+    }
+    
+    void close() {
+        flush();
+        for (Out* o : {&json, &junit}) {
+            if (o->fd >= 0) ::close(o->fd);
+            o->fd = -1;
         }
     }
-    return result;
-}
 
-vector<int> generate_range(int start, int end) {
-    vector<int> result;
-    for (int i = start; i <= end; ++i) result.push_back(i);
-    return result;
-}
+private:
+    struct Out {
+        int fd = -1;
+        string buf;
+        off_t end = 0;      // JUnit: where the footer starts
+    };
+    
+    Out json, junit;
+    int tests = 0, failures = 0, errors = 0;
+    
+    string junit_header() const {
+        string counts = "tests=\"" + to_string(tests) + "\" failures=\"" + to_string(failures) +
+                        "\" errors=\"" + to_string(errors) + "\"";
+        counts.resize(64, ' ');
+        return "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n<testsuites>\n  <testsuite name=\"push_swap\" " +
+               counts + ">\n";
+    }
+    
+    static bool write_at(int fd, const string& data, off_t at) {
+        size_t done = 0;
+        while (done < data.size()) {
+            ssize_t n = pwrite(fd, data.data() + done, data.size() - done, at + done);
+            if (n < 0 && errno == EINTR) continue;
+            if (n <= 0) return false;
+            done += n;
+        }
+        return true;
+    }
+    
+    void flush() {
+        if (json.fd >= 0 && !json.buf.empty()) {
+            write_at(json.fd, json.buf, json.end);
+            json.end += json.buf.size();
+            json.buf.clear();
+        }
+        if (junit.fd >= 0) {
+            write_at(junit.fd, junit.buf + "  </testsuite>\n</testsuites>\n", junit.end);
+            junit.end += junit.buf.size();
+            junit.buf.clear();
+            write_at(junit.fd, junit_header(), 0);
+        }
+    }
+};
 
-vector<int> generate_reversed(int n) {
-    vector<int> result;
-    for (int i = n; i >= 1; --i) result.push_back(i);
-    return result;
-}
+ResultStreams result_streams;
 
-vector<int> generate_nearly_sorted(int n, int swaps = 2) {
-    vector<int> result = generate_range(1, n);
-    random_device rd;
-    mt19937 gen(rd());
-    for (int i = 0; i < swaps && n > 1; ++i) {
-        int a = gen() % n;
-        int b = gen() % n;
-        swap(result[a], result[b]);
-    }
-    return result;
+// Records a test that doesn't go through TestResult in the result streams
+void report_test(const string& name, const string& category, bool passed, const string& details,
+                 const ExecResult& r, int ops = 0, uint64_t seed = 0) {
+    if (!result_streams.active()) return;
+    ResultRecord rec = make_record(name, category, r);
+    rec.passed = passed;
+    rec.details = details;
+    rec.instruction_count = ops;
+    result_streams.emit(rec, seed);
 }
 
-vector<int> generate_rotated(int n, int rot = -1) {
-    vector<int> result = generate_range(1, n);
-    if (rot < 0) rot = n / 2;
-    rotate(result.begin(), result.begin() + rot, result.end());
-    return result;
+// Files `t` in all_results and the result streams, and frees its outputs
+void record_result(TestResult& t) {
+    ResultRecord rec = make_record(t.name, t.category, t.exec);
+    rec.status = t.status;
+    rec.details = t.details;
+    rec.passed = t.passed;
+    rec.instruction_count = t.instruction_count;
+    rec.spill_offset = t.spill_offset;
+    rec.spill_size = t.spill_size;
+    result_streams.emit(rec, t.seed);
+    all_results.push_back(move(rec));
+    t.exec = ExecResult();
 }
 
 // ==================================================================================
-// Process Execution
+// Parallel Execution
 // ==================================================================================
+//
+// Every test is split in two halves: `work` runs the child process(es) on a
+// worker thread, `commit` scores the result, updates Stats/all_results and
+// prints. Commits always run one at a time and in submission order, so the
+// console output and every counter match a sequential run exactly.
+// With a single job everything runs inline on the calling thread.
+//
+// Valgrind jobs can take hundreds of MB each, so they pass a MemoryGate
+// before starting: one is admitted only while the projected peak RSS of all
+// running ones fits cfg.mem_budget. A job waiting at the gate doesn't hold
+// up native jobs queued behind it, those keep the workers busy.
 
-ExecResult execute_command(const vector<string>& cmd, const string& input = "", 
-                           bool with_valgrind = false, int timeout = -1) {
-    ExecResult result;
-    if (timeout < 0) timeout = cfg.timeout_sec;
-    
-    int pipe_stdin[2], pipe_stdout[2], pipe_stderr[2];
-    
-    if (pipe(pipe_stdin) < 0 || pipe(pipe_stdout) < 0 || pipe(pipe_stderr) < 0) {
-        result.stderr_data = "Failed to create pipes";
-        result.exit_code = -1;
-        return result;
+// Largest child peak RSS seen by the task running on this thread
+thread_local size_t task_peak_rss = 0;
+
+// Admission key for a task running `n` numbers through valgrind: jobs of the
+// same size class share a peak RSS estimate. -1 means a native job.
+int valgrind_job(bool with_valgrind, size_t n) {
+    if (!with_valgrind || !cfg.use_valgrind || !cfg.leak_shim.empty()) return -1;
+    int key = 0;
+    while (n > 1) {
+        n >>= 1;
+        key++;
     }
-    auto start_time = chrono::high_resolution_clock::now();
-    
-    pid_t pid = fork();
-    if (pid < 0) {
-        result.stderr_data = "Fork failed";
-        result.exit_code = -1;
-        return result;
+    return key;
+}
+
+// Guarded by the pool's mutex
+struct MemoryGate {
+    size_t budget = 0;              // 0 = no limit
+    size_t reserved = 0;            // sum of the running jobs' estimates
+    int running = 0;
+    map<int, size_t> peak;          // size class -> largest peak RSS seen
+    
+    // A size class not seen yet gets the whole budget: it runs alone once
+    size_t estimate(int key) const {
+        auto it = peak.find(key);
+        return it != peak.end() ? it->second : budget;
     }
     
-    if (pid == 0) {
-        // Child process
-        close(pipe_stdin[1]);
-        close(pipe_stdout[0]);
-        close(pipe_stderr[0]);
-        
-        dup2(pipe_stdin[0], STDIN_FILENO);
-        dup2(pipe_stdout[1], STDOUT_FILENO);
-        dup2(pipe_stderr[1], STDERR_FILENO);
-        
-        close(pipe_stdin[0]);
-        close(pipe_stdout[1]);
-        close(pipe_stderr[1]);
-        
-        // Build command
-        vector<const char*> args;
-        for (const auto& s : cmd) args.push_back(s.c_str());
-        args.push_back(nullptr);
-        
-        execvp(args[0], const_cast<char* const*>(args.data()));
-        _exit(127);
+    bool try_admit(int key, size_t& reservation) {
+        reservation = estimate(key);
+        if (running > 0 && reserved + reservation > budget) return false;
+        reserved += reservation;
+        running++;
+        return true;
     }
     
-    // Parent process
-    close(pipe_stdin[0]);
-    close(pipe_stdout[1]);
-    close(pipe_stderr[1]);
-    
-    // Set non-blocking for stdout/stderr
-    fcntl(pipe_stdout[0], F_SETFL, O_NONBLOCK);
-    fcntl(pipe_stderr[0], F_SETFL, O_NONBLOCK);
-    
-    // Write input
-    if (!input.empty()) {
-        ssize_t written __attribute__((unused)) = write(pipe_stdin[1], input.c_str(), input.size());
+    void release(int key, size_t reservation, size_t rss) {
+        reserved -= reservation;
+        running--;
+        if (rss > 0) peak[key] = max(peak.count(key) ? peak[key] : 0, rss);
     }
-    close(pipe_stdin[1]);
-    
-    // Wait with timeout
-    int status;
-    int elapsed_ms = 0;
-    const int poll_interval_ms = 10;
-    
-    while (waitpid(pid, &status, WNOHANG) == 0) {
-        if (elapsed_ms >= timeout * 1000) {
-            kill(pid, SIGKILL);
-            waitpid(pid, &status, 0);
-            result.timed_out = true;
-            break;
+};
+
+class TaskPool {
+public:
+    void start(int n) {
+        for (int i = 0; i < n; ++i) threads.emplace_back([this] { worker_loop(); });
+    }
+
+    void stop() {
+        drain();
+        {
+            lock_guard<mutex> lock(m);
+            stopping = true;
         }
-        usleep(poll_interval_ms * 1000);
-        elapsed_ms += poll_interval_ms;
+        cv_work.notify_all();
+        for (auto& t : threads) t.join();
+        threads.clear();
     }
+
+    // `mem_key` from valgrind_job() puts the work behind the memory gate
+    void submit(function<void()> work, function<void()> commit = nullptr, int mem_key = -1) {
+        if (threads.empty()) {
+            if (work) work();
+            if (commit) commit();
+            return;
+        }
+        {
+            unique_lock<mutex> lock(m);
+            // Backpressure: don't let the producer run arbitrarily far ahead
+            cv_done.wait(lock, [this] { return next_seq - next_commit < max_in_flight; });
+            tasks.push_back({move(work), move(commit), false, false, mem_key});
+            if (!tasks.back().work) tasks.back().done = tasks.back().started = true;
+            next_seq++;
+        }
+        cv_work.notify_one();
+        run_commits();
+    }
+
+    // Runs `fn` once everything submitted before it has committed
+    void ordered(function<void()> fn) { submit(nullptr, move(fn)); }
+
+    void drain() {
+        if (threads.empty()) return;
+        unique_lock<mutex> lock(m);
+        cv_done.wait(lock, [this] { return next_commit == next_seq; });
+    }
+
+    size_t size() const { return threads.size(); }
     
-    auto end_time = chrono::high_resolution_clock::now();
-    result.exec_time_ms = chrono::duration<double, milli>(end_time - start_time).count();
-    
-    // Read output
-    char buf[8192];
-    ssize_t n;
-    while ((n = read(pipe_stdout[0], buf, sizeof(buf))) > 0) {
-        result.stdout_data.append(buf, n);
+    void set_mem_budget(size_t bytes) { gate.budget = bytes; }
+
+private:
+    struct Task {
+        function<void()> work;
+        function<void()> commit;
+        bool done;
+        bool started;
+        int mem_key;
+    };
+
+    deque<Task> tasks;          // tasks[0] has sequence number next_commit
+    size_t next_seq = 0;        // sequence number of the next submitted task
+    size_t next_work = 0;       // next task a worker should pick up
+    size_t next_commit = 0;     // next task whose commit is due
+    bool committing = false;
+    bool stopping = false;
+    const size_t max_in_flight = 4096;
+    MemoryGate gate;
+    mutex m;
+    condition_variable cv_work, cv_done;
+    vector<thread> threads;
+    
+    // Finds the oldest task that may start: native ones always can, valgrind
+    // ones go through the gate in order (the first one waiting blocks the
+    // others, so a big job can't be starved by smaller ones)
+    bool pick(size_t& seq, size_t& reservation) {
+        while (next_work < next_seq && tasks[next_work - next_commit].started) next_work++;
+        bool gated = false;
+        for (size_t s = next_work; s < next_seq; ++s) {
+            const Task& t = tasks[s - next_commit];
+            if (t.started) continue;
+            if (t.mem_key >= 0 && gate.budget > 0) {
+                if (gated) continue;
+                gated = true;
+                if (!gate.try_admit(t.mem_key, reservation)) continue;
+            }
+            seq = s;
+            return true;
+        }
+        return false;
+    }
+
+    void worker_loop() {
+        unique_lock<mutex> lock(m);
+        while (true) {
+            size_t seq = 0, reservation = 0;
+            bool picked = false;
+            cv_work.wait(lock, [&] {
+                picked = pick(seq, reservation);
+                return picked || (stopping && next_work >= next_seq);
+            });
+            if (!picked) return;
+            Task& t = tasks[seq - next_commit];
+            t.started = true;
+            int mem_key = gate.budget > 0 ? t.mem_key : -1;
+            auto work = move(t.work);
+            lock.unlock();
+            task_peak_rss = 0;
+            work();
+            lock.lock();
+            tasks[seq - next_commit].done = true;
+            if (mem_key >= 0) {
+                gate.release(mem_key, reservation, task_peak_rss);
+                cv_work.notify_all();
+            }
+            lock.unlock();
+            run_commits();
+            lock.lock();
+        }
+    }
+
+    // Whoever finishes the head task commits every ready task behind it
+    void run_commits() {
+        unique_lock<mutex> lock(m);
+        if (committing) return;
+        committing = true;
+        while (!tasks.empty() && tasks.front().done) {
+            auto commit = move(tasks.front().commit);
+            lock.unlock();
+            if (commit) commit();
+            lock.lock();
+            tasks.pop_front();
+            next_commit++;
+            if (next_work < next_commit) next_work = next_commit;
+            cv_done.notify_all();
+        }
+        committing = false;
+    }
+};
+
+TaskPool pool;
+
+// ==================================================================================
+// Async Logger
+// ==================================================================================
+
+// trace.log and errors.txt are written by one thread: workers queue a
+// closure that formats the entry (bounded, they wait when it's full) and
+// the logger formats and appends it to a buffer per file, written out when
+// large or idle. stop() drains everything; SIGINT/SIGTERM/SIGHUP flush
+// before the default action runs.
+volatile sig_atomic_t log_signal = 0;
+
+void on_fatal_signal(int sig) { log_signal = sig; }
+
+class AsyncLogger {
+public:
+    enum Sink { TRACE, ERRORS };
+    using Format = function<void(string&)>;
+    
+    void start() {
+        struct sigaction sa;
+        memset(&sa, 0, sizeof(sa));
+        sa.sa_handler = on_fatal_signal;
+        sa.sa_flags = SA_RESETHAND;  // a second one kills right away
+        for (int sig : {SIGINT, SIGTERM, SIGHUP}) sigaction(sig, &sa, nullptr);
+        worker = thread([this] { run(); });
     }
-    while ((n = read(pipe_stderr[0], buf, sizeof(buf))) > 0) {
-        result.stderr_data.append(buf, n);
+    
+    void post(Sink sink, Format format) {
+        unique_lock<mutex> lock(m);
+        if (!worker.joinable()) {
+            format(bufs[sink]);
+            write_out(sink);
+            return;
+        }
+        cv_space.wait(lock, [this] { return queue.size() < capacity; });
+        queue.push_back({sink, move(format)});
+        if (queue.size() == 1) cv_items.notify_one();
     }
     
-    close(pipe_stdout[0]);
-    close(pipe_stderr[0]);
+    void stop() {
+        if (!worker.joinable()) return;
+        {
+            lock_guard<mutex> lock(m);
+            stopping = true;
+        }
+        cv_items.notify_one();
+        worker.join();
+        for (int& fd : fds) {
+            if (fd >= 0) close(fd);
+            fd = -1;
+        }
+    }
+
+private:
+    struct Entry {
+        Sink sink;
+        Format format;
+    };
     
-    if (!result.timed_out) {
-        if (WIFEXITED(status)) {
-            result.exit_code = WEXITSTATUS(status);
+    deque<Entry> queue;
+    const size_t capacity = 8192;
+    const size_t flush_at = 1 << 20;
+    string bufs[2];
+    int fds[2] = {-1, -1};
+    bool stopping = false;
+    mutex m;
+    condition_variable cv_items, cv_space;
+    thread worker;
+    
+    void write_out(int sink) {
+        string& buf = bufs[sink];
+        if (buf.empty()) return;
+        if (fds[sink] < 0) {
+            const string& path = sink == TRACE ? cfg.trace_file : cfg.errors_file;
+            fds[sink] = open(path.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
         }
-        if (WIFSIGNALED(status)) {
-            result.signal_num = WTERMSIG(status);
+        const char* p = buf.data();
+        size_t left = buf.size();
+        while (fds[sink] >= 0 && left > 0) {
+            ssize_t n = write(fds[sink], p, left);
+            if (n < 0 && errno == EINTR) continue;
+            if (n <= 0) break;
+            p += n;
+            left -= n;
         }
+        buf.clear();
     }
     
-    // Parse valgrind output if applicable
-    if (with_valgrind && !result.stderr_data.empty()) {
-        // Check for "definitely lost"
-        if (result.stderr_data.find("definitely lost:") != string::npos) {
-            size_t pos = result.stderr_data.find("definitely lost:");
-            if (pos != string::npos) {
-                size_t start = pos + 17;  // "definitely lost:" is 16 chars + skip colon
-                // Skip any whitespace after the colon
-                while (start < result.stderr_data.size() && 
-                       (result.stderr_data[start] == ' ' || result.stderr_data[start] == '\t')) {
-                    start++;
-                }
-                string bytes_str;
-                while (start < result.stderr_data.size() && 
-                       (isdigit(result.stderr_data[start]) || result.stderr_data[start] == ',')) {
-                    if (result.stderr_data[start] != ',') bytes_str += result.stderr_data[start];
-                    start++;
-                }
-                if (!bytes_str.empty()) {
-                    result.leaked_bytes = stoi(bytes_str);
-                    if (result.leaked_bytes > 0) result.has_leaks = true;
-                }
+    void run() {
+        unique_lock<mutex> lock(m);
+        while (true) {
+            // Wake up now and then to notice a signal and flush when idle
+            bool idle = !cv_items.wait_for(lock, chrono::milliseconds(100),
+                                           [this] { return !queue.empty() || stopping || log_signal; });
+            deque<Entry> batch;
+            batch.swap(queue);
+            cv_space.notify_all();
+            lock.unlock();
+            
+            for (auto& e : batch) {
+                e.format(bufs[e.sink]);
+                if (bufs[e.sink].size() >= flush_at) write_out(e.sink);
             }
-        }
-        
-        // Check for errors
-        if (result.stderr_data.find("ERROR SUMMARY:") != string::npos) {
-            size_t pos = result.stderr_data.find("ERROR SUMMARY:");
-            if (pos != string::npos) {
-                size_t start = pos + 15;
-                string err_str;
-                while (start < result.stderr_data.size() && isdigit(result.stderr_data[start])) {
-                    err_str += result.stderr_data[start++];
-                }
-                if (!err_str.empty()) {
-                    result.error_count = stoi(err_str);
-                    if (result.error_count > 0) result.has_errors = true;
-                }
+            
+            lock.lock();
+            bool done = stopping && queue.empty();
+            if (idle || done || log_signal) {
+                write_out(TRACE);
+                write_out(ERRORS);
             }
+            if (log_signal) {
+                int sig = log_signal;
+                lock.unlock();
+                signal(sig, SIG_DFL);
+                raise(sig);
+                return;
+            }
+            if (done) return;
         }
+    }
+};
+
+AsyncLogger logger;
+
+// ==================================================================================
+// Utility Functions
+// ==================================================================================
+
+// The leak checker's findings (per-kind totals, invalid accesses and their
+// stacks) for trace.log/errors.txt, empty when there's nothing to show
+string leak_report(const ExecResult& r) {
+    if (r.leak_summary.empty() || (!r.has_leaks && r.invalid_reads == 0 && r.invalid_writes == 0)) return "";
+    string out = "\n";
+    istringstream lines(r.leak_summary);
+    for (string line; getline(lines, line);) out += "    " + line + "\n";
+    out.pop_back();
+    return out;
+}
+
+// Entries are formatted on the logger thread, only the time is taken here
+void log_trace(const string& name, const vector<string>& args, const string& extra = "") {
+    time_t t = chrono::system_clock::to_time_t(chrono::system_clock::now());
+    logger.post(AsyncLogger::TRACE, [=](string& out) {
+        ostringstream f;
+        f << "[" << put_time(localtime(&t), "%H:%M:%S") << "] " << name << "\n";
         
-        // Check for "All heap blocks were freed"
-        if (result.stderr_data.find("All heap blocks were freed") != string::npos) {
-            result.has_leaks = false;
-            result.leaked_bytes = 0;
+        // Show actual command with valgrind if enabled
+        if (cfg.use_valgrind) {
+            f << "  Command: valgrind --leak-check=full " << cfg.push_swap;
+        } else {
+            f << "  Command: " << cfg.push_swap;
         }
-        
-        // Store summary
-        size_t sum_pos = result.stderr_data.find("LEAK SUMMARY:");
-        if (sum_pos != string::npos) {
-            size_t end_pos = result.stderr_data.find("ERROR SUMMARY:", sum_pos);
-            if (end_pos != string::npos) {
-                result.valgrind_summary = result.stderr_data.substr(sum_pos, end_pos - sum_pos);
+        for (const auto& s : args) f << " \"" << s << "\"";
+        f << "\n";
+        if (!extra.empty()) f << "  Details: " << extra << "\n";
+        f << "\n";
+        out += f.str();
+    });
+}
+
+void log_error(const string& test_name, const string& category, const string& details, const vector<string>& args = {},
+               uint64_t seed = 0) {
+    // Only the first 20 arguments are shown
+    vector<string> shown(args.begin(), args.begin() + min(args.size(), (size_t)20));
+    size_t total = args.size();
+    logger.post(AsyncLogger::ERRORS, [=](string& out) {
+        ostringstream f;
+        f << "━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━\n";
+        f << "FAILED: " << test_name << "\n";
+        f << "Category: " << category << "\n";
+        if (!shown.empty()) {
+            f << "Input: ";
+            for (size_t i = 0; i < shown.size(); ++i) {
+                f << shown[i];
+                if (i < total - 1) f << " ";
             }
+            if (total > 20) f << "... (" << total << " total)";
+            f << "\n";
         }
+        if (!details.empty()) f << "Reason: " << details << "\n";
+        if (seed != 0) f << "Seed: " << seed << " (from run seed --seed " << cfg.seed << ")\n";
+        f << "\n";
+        out += f.str();
+    });
+}
+
+string vec_to_args(const vector<int>& v) {
+    string s;
+    for (size_t i = 0; i < v.size(); ++i) {
+        if (i > 0) s += " ";
+        s += to_string(v[i]);
     }
-    
+    return s;
+}
+
+vector<string> split_string(const string& s) {
+    vector<string> result;
+    istringstream iss(s);
+    string token;
+    while (iss >> token) result.push_back(token);
     return result;
 }
 
-ExecResult run_push_swap(const vector<string>& args, bool with_valgrind = false) {
-    vector<string> cmd;
-    if (with_valgrind && cfg.use_valgrind) {
-        cmd = {"valgrind", "--leak-check=full", "--show-leak-kinds=all", 
-               "--errors-for-leak-kinds=all", "--error-exitcode=42", 
-               cfg.push_swap};
-    } else {
-        cmd = {cfg.push_swap};
+// "64M" / "512k" / "1G" / plain bytes; returns 0 if unparsable
+size_t parse_size(const string& s) {
+    char* end = nullptr;
+    double v = strtod(s.c_str(), &end);
+    if (end == s.c_str() || v <= 0) return 0;
+    switch (tolower(*end)) {
+        case 'k': v *= 1024; break;
+        case 'm': v *= 1024 * 1024; break;
+        case 'g': v *= 1024.0 * 1024 * 1024; break;
+        case '\0': break;
+        default: return 0;
     }
-    cmd.insert(cmd.end(), args.begin(), args.end());
-    return execute_command(cmd, "", with_valgrind);
+    return (size_t)v;
 }
 
-ExecResult run_checker(const vector<string>& args, const string& instructions, bool with_valgrind = false) {
-    vector<string> cmd;
-    if (with_valgrind && cfg.use_valgrind) {
-        cmd = {"valgrind", "--leak-check=full", "--show-leak-kinds=all", 
-               "--errors-for-leak-kinds=all", "--error-exitcode=42", 
-               cfg.checker};
+string format_bytes(size_t bytes) {
+    ostringstream os;
+    if (bytes >= (1u << 30)) os << fixed << setprecision(1) << bytes / double(1u << 30) << " GB";
+    else if (bytes >= (1u << 20)) os << fixed << setprecision(1) << bytes / double(1u << 20) << " MB";
+    else if (bytes >= (1u << 10)) os << fixed << setprecision(1) << bytes / double(1u << 10) << " KB";
+    else os << bytes << " B";
+    return os.str();
+}
+
+// The child's rusage for errors.txt, empty when it isn't known
+string usage_report(const ExecResult& r) {
+    if (r.max_rss == 0) return "";
+    ostringstream os;
+    os << fixed << setprecision(1) << "\n    Resources: " << r.user_ms << " ms user, " << r.sys_ms << " ms sys, "
+       << (r.max_rss_bound ? "≤ " : "") << format_bytes(r.max_rss) << " max RSS, " << r.minor_faults << " minor / " << r.major_faults
+       << " major faults, " << r.vol_switches << " voluntary / " << r.invol_switches << " involuntary switches";
+    return os.str();
+}
+
+// Per-run averages of a benchmark size, peak RSS as the largest
+string usage_line(const UsageTotals& u) {
+    if (u.runs == 0) return "";
+    ostringstream os;
+    os << fixed << setprecision(2) << u.user_ms / u.runs << " ms user + " << u.sys_ms / u.runs << " ms sys, peak RSS "
+       << (u.max_rss_bound ? "≤ " : "") << format_bytes(u.max_rss) << setprecision(0) << ", faults " << (double)u.minor_faults / u.runs << " minor / "
+       << (double)u.major_faults / u.runs << " major, switches " << (double)u.vol_switches / u.runs << " vol / "
+       << (double)u.invol_switches / u.runs << " invol";
+    return os.str();
+}
+
+// SHA-256 (FIPS 180-4), for the result cache keys
+struct Sha256 {
+    uint32_t h[8] = {0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a,
+                     0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19};
+    unsigned char block[64];
+    size_t used = 0;
+    uint64_t total = 0;
+    
+    static uint32_t rotr(uint32_t x, int n) { return (x >> n) | (x << (32 - n)); }
+    
+    void compress() {
+        static const uint32_t k[64] = {
+            0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+            0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+            0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+            0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+            0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+            0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+            0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+            0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2};
+        uint32_t w[64];
+        for (int i = 0; i < 16; ++i) {
+            w[i] = (uint32_t)block[4 * i] << 24 | (uint32_t)block[4 * i + 1] << 16 |
+                   (uint32_t)block[4 * i + 2] << 8 | block[4 * i + 3];
+        }
+        for (int i = 16; i < 64; ++i) {
+            uint32_t s0 = rotr(w[i - 15], 7) ^ rotr(w[i - 15], 18) ^ (w[i - 15] >> 3);
+            uint32_t s1 = rotr(w[i - 2], 17) ^ rotr(w[i - 2], 19) ^ (w[i - 2] >> 10);
+            w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+        }
+        uint32_t a = h[0], b = h[1], c = h[2], d = h[3], e = h[4], f = h[5], g = h[6], hh = h[7];
+        for (int i = 0; i < 64; ++i) {
+            uint32_t t1 = hh + (rotr(e, 6) ^ rotr(e, 11) ^ rotr(e, 25)) + ((e & f) ^ (~e & g)) + k[i] + w[i];
+            uint32_t t2 = (rotr(a, 2) ^ rotr(a, 13) ^ rotr(a, 22)) + ((a & b) ^ (a & c) ^ (b & c));
+            hh = g; g = f; f = e; e = d + t1;
+            d = c; c = b; b = a; a = t1 + t2;
+        }
+        h[0] += a; h[1] += b; h[2] += c; h[3] += d;
+        h[4] += e; h[5] += f; h[6] += g; h[7] += hh;
+    }
+    
+    void update(const void* data, size_t len) {
+        const unsigned char* p = (const unsigned char*)data;
+        total += len;
+        while (len > 0) {
+            size_t n = min(len, sizeof(block) - used);
+            memcpy(block + used, p, n);
+            used += n;
+            p += n;
+            len -= n;
+            if (used == sizeof(block)) {
+                compress();
+                used = 0;
+            }
+        }
+    }
+    void update(const string& s) { update(s.data(), s.size()); }
+    
+    // Length-prefixed, so consecutive fields can't run into each other
+    void field(const string& s) {
+        uint64_t len = s.size();
+        update(&len, sizeof(len));
+        update(s);
+    }
+    
+    // The 32 raw digest bytes
+    string digest() {
+        uint64_t bits = total * 8;
+        unsigned char pad = 0x80;
+        update(&pad, 1);
+        pad = 0;
+        while (used != 56) update(&pad, 1);
+        for (int i = 7; i >= 0; --i) {
+            unsigned char byte = (unsigned char)(bits >> (8 * i));
+            update(&byte, 1);
+        }
+        string out(32, '\0');
+        for (int i = 0; i < 32; ++i) out[i] = (char)(h[i / 4] >> (24 - 8 * (i % 4)));
+        return out;
+    }
+};
+
+int count_instructions(const string& output) {
+    if (output.empty()) return 0;
+    int count = 0;
+    for (char c : output) if (c == '\n') count++;
+    if (!output.empty() && output.back() != '\n') count++;
+    return count;
+}
+
+string get_grade(int avg, const vector<Threshold>& thresholds) {
+    for (const auto& t : thresholds) {
+        if (avg <= t.limit) return t.grade;
+    }
+    return "0/5";
+}
+
+int get_score(int avg, const vector<Threshold>& thresholds) {
+    for (const auto& t : thresholds) {
+        if (avg <= t.limit) return t.score;
+    }
+    return 0;
+}
+
+// 95% confidence interval of the mean of `sorted` (normal approximation),
+// or with q in (0, 1) of its q-quantile (distribution-free, from order
+// statistics)
+pair<double, double> confidence_interval(const vector<int>& sorted, double q = -1) {
+    const double z = 1.96;
+    size_t n = sorted.size();
+    if (n == 0) return {0, 0};
+    if (q < 0) {
+        double mean = accumulate(sorted.begin(), sorted.end(), 0.0) / n;
+        double ss = 0;
+        for (int x : sorted) ss += (x - mean) * (x - mean);
+        double half = n > 1 ? z * sqrt(ss / (n - 1) / n) : 0;
+        return {mean - half, mean + half};
+    }
+    double center = n * q, spread = z * sqrt(n * q * (1 - q));
+    long lo = max(0L, (long)floor(center - spread));
+    long hi = min((long)n - 1, (long)ceil(center + spread));
+    return {(double)sorted[lo], (double)sorted[hi]};
+}
+
+// The whole interval scores the same: more samples won't change the grade
+bool grade_settled(pair<double, double> ci, const vector<Threshold>& thresholds) {
+    return get_score((int)floor(ci.first), thresholds) == get_score((int)floor(ci.second), thresholds);
+}
+
+// 95% Wilson score interval of a proportion; stays meaningful when `hits`
+// is 0 or n, unlike the normal approximation
+pair<double, double> wilson_interval(int hits, int n) {
+    if (n == 0) return {0, 1};
+    const double z = 1.96;
+    double p = (double)hits / n, z2 = z * z;
+    double denom = 1 + z2 / n;
+    double center = (p + z2 / (2 * n)) / denom;
+    double half = z * sqrt(p * (1 - p) / n + z2 / (4.0 * n * n)) / denom;
+    return {max(0.0, center - half), min(1.0, center + half)};
+}
+
+string stat_name(double q) {
+    return q < 0 ? "mean" : "P" + to_string((int)lround(q * 100));
+}
+
+// Regularized incomplete beta I_x(a, b), continued fraction (modified Lentz)
+double incomplete_beta(double a, double b, double x) {
+    if (x <= 0) return 0;
+    if (x >= 1) return 1;
+    if (x > (a + 1) / (a + b + 2)) return 1 - incomplete_beta(b, a, 1 - x);
+    double front = exp(lgamma(a + b) - lgamma(a) - lgamma(b) + a * log(x) + b * log(1 - x)) / a;
+    const double tiny = 1e-300;
+    double f = 1, c = 1, d = 0;
+    for (int i = 0; i <= 400; ++i) {
+        int m = i / 2;
+        double num;
+        if (i == 0) num = 1;
+        else if (i % 2 == 0) num = (m * (b - m) * x) / ((a + 2 * m - 1) * (a + 2 * m));
+        else num = -((a + m) * (a + b + m) * x) / ((a + 2 * m) * (a + 2 * m + 1));
+        d = 1 + num * d;
+        if (fabs(d) < tiny) d = tiny;
+        d = 1 / d;
+        c = 1 + num / c;
+        if (fabs(c) < tiny) c = tiny;
+        f *= c * d;
+        if (fabs(1 - c * d) < 1e-12) break;
+    }
+    return front * (f - 1);
+}
+
+// Two-sided p-value of Student's t with `df` degrees of freedom
+double t_test_p(double t, double df) {
+    return incomplete_beta(df / 2, 0.5, df / (df + t * t));
+}
+
+// Paired t-test of per-input differences: mean, its 95% CI and p
+struct PairedTest {
+    size_t n = 0;
+    double mean = 0, lo = 0, hi = 0, p = 1;
+};
+
+PairedTest paired_t_test(const vector<double>& diffs) {
+    PairedTest r;
+    r.n = diffs.size();
+    if (r.n == 0) return r;
+    r.mean = accumulate(diffs.begin(), diffs.end(), 0.0) / r.n;
+    r.lo = r.hi = r.mean;
+    if (r.n < 2) return r;
+    double ss = 0;
+    for (double d : diffs) ss += (d - r.mean) * (d - r.mean);
+    double se = sqrt(ss / (r.n - 1) / r.n);
+    double df = r.n - 1;
+    if (se == 0) {
+        r.p = r.mean == 0 ? 1 : 0;  // every input moved by the same amount
+        return r;
+    }
+    r.p = t_test_p(r.mean / se, df);
+    // Critical t for 95%, by bisection on the p-value
+    double t_lo = 0, t_hi = 100;
+    for (int i = 0; i < 60; ++i) {
+        double mid = (t_lo + t_hi) / 2;
+        (t_test_p(mid, df) > 0.05 ? t_lo : t_hi) = mid;
+    }
+    r.lo = r.mean - t_hi * se;
+    r.hi = r.mean + t_hi * se;
+    return r;
+}
+
+// Two-sided sign test: the chance of a split at least this uneven if each
+// input were a coin flip between the two (ties left out)
+double sign_test_p(int wins, int losses) {
+    int n = wins + losses;
+    if (n == 0) return 1;
+    double tail = 0;
+    for (int i = 0; i <= min(wins, losses); ++i) {
+        tail += exp(lgamma(n + 1) - lgamma(i + 1) - lgamma(n - i + 1) - n * log(2.0));
+    }
+    return min(1.0, 2 * tail);
+}
+
+// ==================================================================================
+// Instruction Decoding
+// ==================================================================================
+//
+// push_swap's stdout is decoded line by line into one byte per operation;
+// validation, counting and simulation all work on that (see StreamVerifier)
+// instead of re-parsing the text.
+
+enum Op : uint8_t { SA, SB, SS, PA, PB, RA, RB, RR, RRA, RRB, RRR, OP_INVALID };
+
+const char* const OP_NAMES[] = {"sa", "sb", "ss", "pa", "pb", "ra", "rb", "rr", "rra", "rrb", "rrr"};
+
+string invalid_op_message(const string& text, size_t line, size_t offset) {
+    return "Invalid instruction '" + text + "' at line " + to_string(line) +
+           " (byte " + to_string(offset) + ")";
+}
+
+inline uint8_t decode_op(const char* s, size_t len) {
+    if (len == 2) {
+        char x = s[1];
+        int col = (x == 'a') ? 0 : (x == 'b') ? 1 : (x == 's' || x == 'r') ? 2 : -1;
+        if (col < 0) return OP_INVALID;
+        switch (s[0]) {
+            case 's': return x == 'r' ? OP_INVALID : SA + col;
+            case 'p': return col == 2 ? OP_INVALID : PA + col;
+            case 'r': return x == 's' ? OP_INVALID : RA + col;
+        }
+    } else if (len == 3 && s[0] == 'r' && s[1] == 'r') {
+        switch (s[2]) {
+            case 'a': return RRA;
+            case 'b': return RRB;
+            case 'r': return RRR;
+        }
+    }
+    return OP_INVALID;
+}
+
+// ==================================================================================
+// Number Generators
+// ==================================================================================
+
+// Every random input comes from the run seed (--seed, otherwise picked at
+// startup and printed) mixed with the test's name and iteration, so the
+// seed logged with a failure in errors.txt pins down its input. Bounded
+// draws and shuffles are done here rather than with <random>'s
+// distributions, whose output differs between standard libraries.
+using Rng = mt19937_64;
+
+uint64_t mix64(uint64_t x) {
+    x += 0x9e3779b97f4a7c15ULL;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    return x ^ (x >> 31);
+}
+
+uint64_t test_seed(const string& name, uint64_t iteration = 0) {
+    uint64_t h = 1469598103934665603ULL;  // FNV-1a
+    for (unsigned char c : name) {
+        h ^= c;
+        h *= 1099511628211ULL;
+    }
+    return cfg.seed ^ mix64(h ^ mix64(iteration));
+}
+
+// Benchmark iteration `i` (input seed `seed`) gets a valgrind re-run
+bool leak_sampled(int i, uint64_t seed) {
+    if (cfg.leak_sample_first >= 0) return i < cfg.leak_sample_first;
+    return (mix64(seed) % 10000) < cfg.leak_sample_pct * 100;
+}
+
+// Uniform in [0, bound), bound > 0
+uint64_t rand_below(Rng& gen, uint64_t bound) {
+    uint64_t limit = (0 - bound) % bound;  // 2^64 mod bound: reject the uneven tail
+    uint64_t x;
+    do x = gen(); while (x < limit);
+    return x % bound;
+}
+
+template <class T>
+void shuffle_seeded(vector<T>& v, Rng& gen) {
+    for (size_t i = v.size(); i > 1; --i) swap(v[i - 1], v[rand_below(gen, i)]);
+}
+
+// n distinct values from [min_val, max_val] in random order, O(n) whatever
+// the range: partial Fisher-Yates when n covers half the range or more,
+// Floyd's algorithm otherwise. n is capped at the range size.
+vector<int> generate_unique_random(int n, int min_val, int max_val, uint64_t seed) {
+    Rng gen(seed);
+    uint64_t range = (uint64_t)((int64_t)max_val - min_val + 1);
+    size_t count = (size_t)min((uint64_t)max(n, 0), range);
+    vector<int> result;
+    result.reserve(count);
+    
+    if (count * 2 >= range) {
+        vector<int> all(range);
+        iota(all.begin(), all.end(), min_val);
+        for (size_t i = 0; i < count; ++i) swap(all[i], all[i + rand_below(gen, range - i)]);
+        result.assign(all.begin(), all.begin() + count);
     } else {
-        cmd = {cfg.checker};
+        // Floyd picks a uniform subset but not in uniform order
+        unordered_set<uint64_t> chosen;
+        chosen.reserve(count * 2);
+        for (uint64_t j = range - count; j < range; ++j) {
+            uint64_t t = rand_below(gen, j + 1);
+            if (!chosen.insert(t).second) {
+                chosen.insert(j);
+                t = j;
+            }
+            result.push_back((int)((int64_t)min_val + (int64_t)t));
+        }
+        shuffle_seeded(result, gen);
+    }
+    return result;
+}
+
+vector<int> generate_range(int start, int end) {
+    vector<int> result;
+    for (int i = start; i <= end; ++i) result.push_back(i);
+    return result;
+}
+
+vector<int> generate_reversed(int n) {
+    vector<int> result;
+    for (int i = n; i >= 1; --i) result.push_back(i);
+    return result;
+}
+
+vector<int> generate_nearly_sorted(int n, int swaps, uint64_t seed) {
+    vector<int> result = generate_range(1, n);
+    Rng gen(seed);
+    for (int i = 0; i < swaps && n > 1; ++i) {
+        int a = (int)rand_below(gen, n);
+        int b = (int)rand_below(gen, n);
+        swap(result[a], result[b]);
+    }
+    return result;
+}
+
+vector<int> generate_shuffled_range(int start, int end, uint64_t seed) {
+    vector<int> result = generate_range(start, end);
+    Rng gen(seed);
+    shuffle_seeded(result, gen);
+    return result;
+}
+
+vector<int> generate_rotated(int n, int rot = -1) {
+    vector<int> result = generate_range(1, n);
+    if (rot < 0) rot = n / 2;
+    rotate(result.begin(), result.begin() + rot, result.end());
+    return result;
+}
+
+// ==================================================================================
+// Process Execution
+// ==================================================================================
+
+extern char** environ;
+
+// Pipes are close-on-exec so a child spawned by one worker never holds on to
+// another worker's pipe ends (which would delay EOF on that worker's streams).
+// Without pipe2() the flags can't be set atomically, so pipe creation and
+// spawning are serialized instead.
+#ifndef __linux__
+mutex spawn_mutex;
+#endif
+
+// argv for one child, packed into a single buffer that keeps its capacity
+// between spawns: after warm-up, building a command line allocates nothing.
+struct ArgvArena {
+    string buf;
+    vector<size_t> offsets;
+    vector<char*> argv;
+    
+    void clear() {
+        buf.clear();
+        offsets.clear();
+    }
+    void add(const string& s) {
+        offsets.push_back(buf.size());
+        buf.append(s);
+        buf.push_back('\0');
+    }
+    void add(const vector<string>& v) {
+        for (const auto& s : v) add(s);
+    }
+    char* const* finish() {
+        argv.clear();
+        for (size_t off : offsets) argv.push_back(&buf[off]);
+        argv.push_back(nullptr);
+        return argv.data();
+    }
+};
+
+thread_local ArgvArena argv_arena;
+
+// Where valgrind (--xml-fd) or a preloaded leak shim writes its report in
+// the child
+const int REPORT_FD = 197;
+
+// Valgrind's text log goes nowhere: its findings come as XML on REPORT_FD
+// and the program's stderr is left to the program
+const vector<string> VALGRIND_CMD = {
+    "valgrind", "--leak-check=full", "--show-leak-kinds=all",
+    "--errors-for-leak-kinds=all", "--error-exitcode=42",
+    "--xml=yes", "--xml-fd=" + to_string(REPORT_FD), "--log-file=/dev/null"
+};
+
+// The tester's environment with `shim` preloaded (ahead of any LD_PRELOAD
+// already set) and `fd_var` telling it which fd to talk on
+vector<string> preload_env(const string& shim, const string& fd_var, int fd) {
+    vector<string> env;
+    string preload = "LD_PRELOAD=" + shim;
+    for (char** e = environ; *e; ++e) {
+        if (strncmp(*e, "LD_PRELOAD=", 11) == 0) preload += string(":") + (*e + 11);
+        else if (strncmp(*e, (fd_var + "=").c_str(), fd_var.size() + 1) != 0) env.push_back(*e);
+    }
+    env.push_back(preload);
+    env.push_back(fd_var + "=" + to_string(fd));
+    return env;
+}
+
+// Environment for --leak-engine=shim runs, built once in main()
+vector<string> leak_shim_env;
+vector<char*> leak_shim_envp;
+
+// Starts argv[0] with the given fds as its stdin/stdout/stderr, plus
+// `report_fd` as REPORT_FD when given. Returns the pid, or -1 with errno
+// set. posix_spawn() lets libc use vfork/CLONE_VM, so the cost doesn't grow
+// with the tester's own heap the way fork() does.
+pid_t spawn_child(char* const* argv, int in_fd, int out_fd, int err_fd, int report_fd = -1,
+                  char* const* envp = environ) {
+    if (cfg.use_fork) {
+        pid_t pid = fork();
+        if (pid == 0) {
+            // dup2() clears close-on-exec on the standard fds, every other
+            // pipe end is closed by execvp()
+            dup2(in_fd, STDIN_FILENO);
+            dup2(out_fd, STDOUT_FILENO);
+            dup2(err_fd, STDERR_FILENO);
+            if (report_fd >= 0) dup2(report_fd, REPORT_FD);
+            // The tester ignores SIGPIPE, the program under test must not
+            signal(SIGPIPE, SIG_DFL);
+            environ = const_cast<char**>(envp);
+            execvp(argv[0], argv);
+            _exit(127);
+        }
+        return pid;
+    }
+    
+    posix_spawn_file_actions_t actions;
+    posix_spawn_file_actions_init(&actions);
+    posix_spawn_file_actions_adddup2(&actions, in_fd, STDIN_FILENO);
+    posix_spawn_file_actions_adddup2(&actions, out_fd, STDOUT_FILENO);
+    posix_spawn_file_actions_adddup2(&actions, err_fd, STDERR_FILENO);
+    if (report_fd >= 0) posix_spawn_file_actions_adddup2(&actions, report_fd, REPORT_FD);
+    
+    posix_spawnattr_t attr;
+    posix_spawnattr_init(&attr);
+    sigset_t sigdef;
+    sigemptyset(&sigdef);
+    sigaddset(&sigdef, SIGPIPE);
+    posix_spawnattr_setsigdefault(&attr, &sigdef);
+    posix_spawnattr_setflags(&attr, POSIX_SPAWN_SETSIGDEF);
+    
+    pid_t pid = -1;
+    int err = posix_spawnp(&pid, argv[0], &actions, &attr, argv, envp);
+    posix_spawnattr_destroy(&attr);
+    posix_spawn_file_actions_destroy(&actions);
+    if (err != 0) {
+        errno = err;
+        return -1;
+    }
+    return pid;
+}
+
+int open_pipe(int fds[2]) {
+#ifdef __linux__
+    return pipe2(fds, O_CLOEXEC);
+#else
+    if (pipe(fds) < 0) return -1;
+    fcntl(fds[0], F_SETFD, FD_CLOEXEC);
+    fcntl(fds[1], F_SETFD, FD_CLOEXEC);
+    return 0;
+#endif
+}
+
+// Returns an fd that polls readable once `pid` exits, or -1 where pidfds
+// are unavailable (non-Linux or kernels older than 5.3)
+int open_pidfd(pid_t pid) {
+#if defined(__linux__) && defined(SYS_pidfd_open)
+    return (int)syscall(SYS_pidfd_open, pid, 0);
+#else
+    (void)pid;
+    return -1;
+#endif
+}
+
+void close_pipe(int fds[2]) {
+    if (fds[0] >= 0) close(fds[0]);
+    if (fds[1] >= 0) close(fds[1]);
+}
+
+// ==================================================================================
+// Fork Server
+// ==================================================================================
+
+// With --fork-server, push_swap/checker are started once per worker with
+// ps_forkserver.so preloaded. The shim parks the program before main() and
+// forks a fresh copy per test case, skipping execve, ld.so and libc init.
+// The protocol is described in ps_forkserver.c. Test children belong to the
+// server, so their exit status arrives on the control socket, which also
+// stands in for the pidfd in the event loop.
+const int FORK_SERVER_FD = 198;
+
+int open_socketpair(int fds[2]) {
+#ifdef __linux__
+    return socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, fds);
+#else
+    lock_guard<mutex> lock(spawn_mutex);
+    if (socketpair(AF_UNIX, SOCK_STREAM, 0, fds) < 0) return -1;
+    fcntl(fds[0], F_SETFD, FD_CLOEXEC);
+    fcntl(fds[1], F_SETFD, FD_CLOEXEC);
+    return 0;
+#endif
+}
+
+bool read_full(int fd, void* buf, size_t len) {
+    char* p = (char*)buf;
+    while (len > 0) {
+        ssize_t n = read(fd, p, len);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        p += n;
+        len -= n;
+    }
+    return true;
+}
+
+bool write_full(int fd, const void* buf, size_t len) {
+    const char* p = (const char*)buf;
+    while (len > 0) {
+        ssize_t n = write(fd, p, len);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        p += n;
+        len -= n;
+    }
+    return true;
+}
+
+struct ForkServer {
+    pid_t pid = -1;
+    int sock = -1;
+    bool failed = false;  // couldn't attach or died: use normal spawns
+    
+    ForkServer() {}
+    ForkServer(const ForkServer&) = delete;
+    ForkServer& operator=(const ForkServer&) = delete;
+    ~ForkServer() { stop(); }
+    
+    bool start(const string& prog) {
+        int sv[2];
+        if (open_socketpair(sv) < 0) return fail();
+        
+        // Same environment plus the preload, the server's own stdio is /dev/null
+        vector<string> env_strs = preload_env(cfg.fork_server, "PS_FORKSERVER_FD", FORK_SERVER_FD);
+        vector<char*> envp;
+        for (auto& e : env_strs) envp.push_back(&e[0]);
+        envp.push_back(nullptr);
+        char* argv[] = {const_cast<char*>(prog.c_str()), nullptr};
+        
+        posix_spawn_file_actions_t actions;
+        posix_spawn_file_actions_init(&actions);
+        posix_spawn_file_actions_addopen(&actions, STDIN_FILENO, "/dev/null", O_RDONLY, 0);
+        posix_spawn_file_actions_addopen(&actions, STDOUT_FILENO, "/dev/null", O_WRONLY, 0);
+        posix_spawn_file_actions_addopen(&actions, STDERR_FILENO, "/dev/null", O_WRONLY, 0);
+        posix_spawn_file_actions_adddup2(&actions, sv[1], FORK_SERVER_FD);
+        int err = posix_spawn(&pid, argv[0], &actions, nullptr, argv, envp.data());
+        posix_spawn_file_actions_destroy(&actions);
+        close(sv[1]);
+        sock = sv[0];
+        if (err != 0) {
+            pid = -1;
+            return fail();
+        }
+        
+        // A program the shim can't hook just runs main() without arguments
+        // and exits: no hello within the grace period means no server
+        struct pollfd pfd = {sock, POLLIN, 0};
+        char hello[4];
+        if (poll(&pfd, 1, 2000) <= 0 || !read_full(sock, hello, 4) || memcmp(hello, "PSFS", 4) != 0) {
+            return fail();
+        }
+        return true;
+    }
+    
+    // Forks one test run, -1 if the server is gone
+    pid_t spawn(const ArgvArena& arena, int in_fd, int out_fd, int err_fd) {
+        // Arguments after argv[0] are already NUL-separated in the arena
+        size_t begin = arena.offsets.size() > 1 ? arena.offsets[1] : arena.buf.size();
+        uint32_t len = (uint32_t)(arena.buf.size() - begin);
+        
+        int fds[3] = {in_fd, out_fd, err_fd};
+        char cbuf[CMSG_SPACE(sizeof(fds))];
+        memset(cbuf, 0, sizeof(cbuf));
+        struct iovec iov = {&len, sizeof(len)};
+        struct msghdr msg = {};
+        msg.msg_iov = &iov;
+        msg.msg_iovlen = 1;
+        msg.msg_control = cbuf;
+        msg.msg_controllen = sizeof(cbuf);
+        struct cmsghdr* cm = CMSG_FIRSTHDR(&msg);
+        cm->cmsg_level = SOL_SOCKET;
+        cm->cmsg_type = SCM_RIGHTS;
+        cm->cmsg_len = CMSG_LEN(sizeof(fds));
+        memcpy(CMSG_DATA(cm), fds, sizeof(fds));
+        
+        int32_t child = -1;
+        if (sendmsg(sock, &msg, MSG_NOSIGNAL) != (ssize_t)sizeof(len) ||
+            !write_full(sock, arena.buf.data() + begin, len) ||
+            !read_full(sock, &child, sizeof(child))) {
+            fail();
+            return -1;
+        }
+        return child;
+    }
+    
+    // Exit status of the last spawned child, if it's there (or `block`)
+    bool reap(int& status, bool block) {
+        int32_t st;
+        if (!block) {
+            ssize_t n = recv(sock, &st, sizeof(st), MSG_DONTWAIT);
+            if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)) return false;
+            if (n == (ssize_t)sizeof(st)) {
+                status = st;
+                return true;
+            }
+            if (n > 0 && read_full(sock, (char*)&st + n, sizeof(st) - n)) {
+                status = st;
+                return true;
+            }
+        } else if (read_full(sock, &st, sizeof(st))) {
+            status = st;
+            return true;
+        }
+        // Server lost mid-run: the child went with it
+        fail();
+        status = SIGKILL;
+        return true;
+    }
+    
+    bool fail() {
+        failed = true;
+        stop();
+        return false;
+    }
+    
+    void stop() {
+        if (sock >= 0) close(sock);  // EOF makes the server exit
+        sock = -1;
+        if (pid > 0) {
+            kill(pid, SIGKILL);
+            waitpid(pid, nullptr, 0);
+        }
+        pid = -1;
+    }
+};
+
+// One server per worker thread and program, started on first use
+thread_local map<string, ForkServer> fork_servers;
+
+ForkServer* fork_server_for(const string& prog) {
+    if (cfg.fork_server.empty()) return nullptr;
+    auto it = fork_servers.find(prog);
+    if (it == fork_servers.end()) {
+        it = fork_servers.emplace(piecewise_construct, forward_as_tuple(prog), forward_as_tuple()).first;
+        it->second.start(prog);
+    }
+    return it->second.failed ? nullptr : &it->second;
+}
+
+// What a child reads on stdin: an in-memory buffer, a file streamed from
+// disk, or a generator that appends the next chunk and returns false once
+// it has nothing more to give. Fed by execute_command's event loop, so the
+// input can be far larger than a pipe buffer.
+struct InputSource {
+    string data;
+    string file;
+    function<bool(string&)> generator;
+    
+    InputSource() {}
+    InputSource(string s) : data(move(s)) {}
+    InputSource(const char* s) : data(s) {}
+    
+    static InputSource from_file(const string& path) {
+        InputSource in;
+        in.file = path;
+        return in;
+    }
+    static InputSource from_generator(function<bool(string&)> gen) {
+        InputSource in;
+        in.generator = move(gen);
+        return in;
+    }
+};
+
+// Receives stdout chunks as they are read instead of stdout_data; returning
+// false stops the child
+using OutputSink = function<bool(const char*, size_t)>;
+
+// Valgrind's XML report (--xml-fd), parsed a chunk at a time as it arrives:
+// only the <error> being read is held, never the whole document. Fills in
+// the leak/error fields of `out` once finish() is called.
+struct ValgrindXml {
+    enum { DEFINITE, INDIRECT, POSSIBLE, REACHABLE };
+    
+    ExecResult& out;
+    vector<string> path;            // open elements
+    string tag, text;
+    bool in_tag = false;
+    bool seen = false;              // any XML at all: valgrind ran
+    
+    // The <error> being read
+    string kind, what, unique;
+    int64_t bytes = 0, blocks = 0;
+    vector<string> frames;
+    int stacks = 0;
+    string fn, file, line, obj;     // the <frame> being read
+    
+    map<string, string> kinds;      // unique id -> kind, for <errorcounts>
+    string pair_unique;
+    int64_t pair_count = 0;
+    int64_t leak_bytes[4] = {}, leak_blocks[4] = {};
+    int64_t errors = 0;
+    vector<string> reports;         // the first few errors, with their stacks
+    
+    explicit ValgrindXml(ExecResult& result) : out(result) {}
+    
+    void feed(const char* data, size_t len) {
+        for (size_t i = 0; i < len; ++i) {
+            char c = data[i];
+            if (in_tag) {
+                if (c == '>') {
+                    in_tag = false;
+                    on_tag();
+                    tag.clear();
+                } else if (tag.size() < 256) {
+                    tag += c;
+                }
+            } else if (c == '<') {
+                in_tag = true;
+            } else if (text.size() < 4096) {
+                text += c;
+            }
+        }
+    }
+    
+    static string unescape(const string& s) {
+        static const pair<const char*, char> entities[] = {
+            {"&amp;", '&'}, {"&lt;", '<'}, {"&gt;", '>'}, {"&quot;", '"'}, {"&apos;", '\''}};
+        string r;
+        for (size_t i = 0; i < s.size(); ++i) {
+            bool done = false;
+            if (s[i] == '&') {
+                for (auto& e : entities) {
+                    size_t n = strlen(e.first);
+                    if (s.compare(i, n, e.first) == 0) {
+                        r += e.second;
+                        i += n - 1;
+                        done = true;
+                        break;
+                    }
+                }
+            }
+            if (!done) r += s[i];
+        }
+        return r;
+    }
+    
+    bool inside(const char* name) const {
+        return find(path.begin(), path.end(), name) != path.end();
+    }
+    
+    void on_tag() {
+        if (tag.empty() || tag[0] == '?' || tag[0] == '!' || tag.back() == '/') return;
+        seen = true;
+        if (tag[0] != '/') {
+            path.push_back(tag.substr(0, tag.find_first_of(" \t\n")));
+            text.clear();
+            if (path.back() == "error") {
+                kind.clear();
+                what.clear();
+                unique.clear();
+                bytes = blocks = 0;
+                frames.clear();
+                stacks = 0;
+            } else if (path.back() == "frame") {
+                fn.clear();
+                file.clear();
+                line.clear();
+                obj.clear();
+            }
+            return;
+        }
+        string name = tag.substr(1);
+        string value = unescape(text);
+        text.clear();
+        if (!path.empty()) path.pop_back();
+        
+        if (inside("error")) {
+            if (name == "kind") kind = value;
+            else if (name == "unique" && path.back() == "error") unique = value;
+            else if (name == "what" || (name == "text" && path.back() == "xwhat")) what = value;
+            else if (name == "leakedbytes") bytes = atoll(value.c_str());
+            else if (name == "leakedblocks") blocks = atoll(value.c_str());
+            else if (name == "fn") fn = value;
+            else if (name == "file") file = value;
+            else if (name == "line") line = value;
+            else if (name == "obj") obj = value;
+            else if (name == "frame" && stacks == 0 && frames.size() < 12) {
+                string where = !file.empty() ? file + (line.empty() ? "" : ":" + line) : obj;
+                frames.push_back((fn.empty() ? string("???") : fn) + (where.empty() ? "" : " (" + where + ")"));
+            } else if (name == "stack") {
+                stacks++;
+            }
+        } else if (name == "error") {
+            end_error();
+        } else if (inside("errorcounts")) {
+            if (name == "count") pair_count = atoll(value.c_str());
+            else if (name == "unique") pair_unique = value;
+            else if (name == "pair") end_pair();
+        }
+    }
+    
+    void end_error() {
+        kinds[unique] = kind;
+        errors++;
+        int leak = kind == "Leak_DefinitelyLost" ? DEFINITE : kind == "Leak_IndirectlyLost" ? INDIRECT :
+                   kind == "Leak_PossiblyLost" ? POSSIBLE : kind == "Leak_StillReachable" ? REACHABLE : -1;
+        if (leak >= 0) {
+            leak_bytes[leak] += bytes;
+            leak_blocks[leak] += blocks;
+        } else if (kind == "InvalidRead") {
+            out.invalid_reads++;
+        } else if (kind == "InvalidWrite") {
+            out.invalid_writes++;
+        }
+        if (reports.size() < 5 && leak != INDIRECT && leak != REACHABLE) {
+            string r = what.empty() ? kind : what;
+            for (size_t i = 0; i < frames.size(); ++i) r += string(i == 0 ? "\n   at " : "\n   by ") + frames[i];
+            reports.push_back(r);
+        }
+    }
+    
+    // Each error above counted once, <errorcounts> has how often the
+    // non-leak ones really happened
+    void end_pair() {
+        auto it = kinds.find(pair_unique);
+        if (it != kinds.end() && it->second.rfind("Leak_", 0) != 0 && pair_count > 1) {
+            errors += pair_count - 1;
+            if (it->second == "InvalidRead") out.invalid_reads += (int)(pair_count - 1);
+            if (it->second == "InvalidWrite") out.invalid_writes += (int)(pair_count - 1);
+        }
+        pair_count = 0;
+        pair_unique.clear();
+    }
+    
+    void finish() {
+        if (!seen) return;
+        out.leaked_bytes = leak_bytes[DEFINITE];
+        out.leaked_blocks = leak_blocks[DEFINITE];
+        out.indirect_bytes = leak_bytes[INDIRECT];
+        out.possible_bytes = leak_bytes[POSSIBLE];
+        out.reachable_bytes = leak_bytes[REACHABLE];
+        out.has_leaks = out.leaked_bytes > 0;
+        out.error_count = (int)min(errors, (int64_t)INT_MAX);
+        out.has_errors = errors > 0;
+        
+        static const char* names[] = {"definitely lost", "indirectly lost", "  possibly lost", "still reachable"};
+        ostringstream os;
+        os << "LEAK SUMMARY:\n";
+        for (int k = 0; k < 4; ++k) {
+            os << "   " << names[k] << ": " << leak_bytes[k] << " bytes in " << leak_blocks[k] << " blocks\n";
+        }
+        os << "Invalid reads: " << out.invalid_reads << ", invalid writes: " << out.invalid_writes
+           << ", errors: " << errors << "\n";
+        for (const auto& r : reports) os << r << "\n";
+        out.leak_summary = os.str();
+    }
+};
+
+// How a run is checked for leaks, if at all. LEAK_SHIM runs go without
+// valgrind: the shim is preloaded and reports on REPORT_FD.
+enum LeakCheck { LEAK_NONE, LEAK_VALGRIND, LEAK_SHIM };
+
+// Parses the shim's "PSLEAK <bytes> <blocks> <allocs> <peak>" line
+void parse_shim_report(const string& report, ExecResult& result) {
+    long long bytes, blocks, allocs, peak;
+    size_t pos = report.rfind("PSLEAK ");
+    if (pos == string::npos ||
+        sscanf(report.c_str() + pos, "PSLEAK %lld %lld %lld %lld", &bytes, &blocks, &allocs, &peak) != 4) {
+        return;  // killed, crashed or _exit()ed: no report
+    }
+    result.leaked_bytes = bytes;
+    result.leaked_blocks = blocks;
+    result.has_leaks = blocks > 0;
+    result.alloc_count = allocs;
+    result.peak_heap = peak;
+    result.leak_summary = "definitely lost: " + to_string(bytes) + " bytes in " + to_string(blocks) +
+                          " blocks\ntotal heap usage: " + to_string(allocs) + " allocs, peak " +
+                          to_string(peak) + " bytes\n";
+    if (report.find("partial", pos) != string::npos) result.leak_summary += "(tracking table full, partial)\n";
+}
+
+// Runs the command line held in `arena` (see execute_command), through
+// `server` when given
+ExecResult execute_argv(ArgvArena& arena, const InputSource& input, LeakCheck leak, int timeout,
+                        ForkServer* server = nullptr, const OutputSink* on_stdout = nullptr) {
+    ExecResult result;
+    if (timeout < 0) timeout = cfg.timeout_sec;
+    
+    int pipe_stdin[2] = {-1, -1}, pipe_stdout[2] = {-1, -1}, pipe_stderr[2] = {-1, -1};
+    int pipe_report[2] = {-1, -1};
+    
+    int input_fd = -1;
+    if (!input.file.empty()) {
+        input_fd = open(input.file.c_str(), O_RDONLY | O_CLOEXEC);
+        if (input_fd < 0) {
+            result.stderr_data = "Cannot open input file: " + input.file;
+            result.exit_code = -1;
+            return result;
+        }
+    }
+    
+    // Build argv before spawning: the child of a multi-threaded process
+    // must not allocate
+    char* const* argv = arena.finish();
+    
+#ifndef __linux__
+    unique_lock<mutex> spawn_lock(spawn_mutex);
+#endif
+    if (open_pipe(pipe_stdin) < 0 || open_pipe(pipe_stdout) < 0 || open_pipe(pipe_stderr) < 0 ||
+        (leak != LEAK_NONE && open_pipe(pipe_report) < 0)) {
+        close_pipe(pipe_stdin);
+        close_pipe(pipe_stdout);
+        close_pipe(pipe_stderr);
+        close_pipe(pipe_report);
+        if (input_fd >= 0) close(input_fd);
+        result.stderr_data = "Failed to create pipes";
+        result.exit_code = -1;
+        return result;
+    }
+    auto start_time = chrono::high_resolution_clock::now();
+    
+    pid_t pid = -1;
+    if (server) {
+        pid = server->spawn(arena, pipe_stdin[0], pipe_stdout[1], pipe_stderr[1]);
+        if (pid < 0) server = nullptr;  // fall back to a normal spawn
+    }
+    if (!server) {
+        char* const* envp = leak == LEAK_SHIM ? leak_shim_envp.data() : environ;
+        pid = spawn_child(argv, pipe_stdin[0], pipe_stdout[1], pipe_stderr[1], pipe_report[1], envp);
+    }
+    if (pid < 0) {
+        int err = errno;
+        close_pipe(pipe_stdin);
+        close_pipe(pipe_stdout);
+        close_pipe(pipe_stderr);
+        close_pipe(pipe_report);
+        if (input_fd >= 0) close(input_fd);
+        // Same outcome as a forked child whose execvp() failed
+        bool exec_failed = (err == ENOENT || err == EACCES || err == ENOEXEC || err == ENOTDIR);
+        result.stderr_data = string(exec_failed ? "Cannot execute " : "Spawn failed: ") + argv[0] + ": " + strerror(err);
+        result.exit_code = exec_failed ? 127 : -1;
+        return result;
+    }
+#ifndef __linux__
+    spawn_lock.unlock();
+#endif
+    
+    // Parent process
+    close(pipe_stdin[0]);
+    close(pipe_stdout[1]);
+    close(pipe_stderr[1]);
+    if (pipe_report[1] >= 0) close(pipe_report[1]);
+    
+    // Set non-blocking for all pipes
+    fcntl(pipe_stdin[1], F_SETFL, O_NONBLOCK);
+    fcntl(pipe_stdout[0], F_SETFL, O_NONBLOCK);
+    fcntl(pipe_stderr[0], F_SETFL, O_NONBLOCK);
+    if (pipe_report[0] >= 0) fcntl(pipe_report[0], F_SETFL, O_NONBLOCK);
+    
+    // Stdin feeder state: `pending` holds the chunk being written when the
+    // input isn't already one in-memory buffer
+    int in_fd = pipe_stdin[1];
+    const char* in_ptr = input.data.data();
+    size_t in_left = input.data.size();
+    string pending;
+    auto in_gen = input.generator;
+    bool in_more = (input_fd >= 0 || in_gen);
+    
+    auto refill = [&]() {
+        pending.clear();
+        if (input_fd >= 0) {
+            pending.resize(65536);
+            ssize_t n = read(input_fd, &pending[0], pending.size());
+            pending.resize(n > 0 ? n : 0);
+            if (n <= 0) in_more = false;
+        } else if (in_gen) {
+            while (pending.empty() && in_more) in_more = in_gen(pending);
+        }
+        in_ptr = pending.data();
+        in_left = pending.size();
+    };
+    
+    auto close_input = [&]() {
+        if (in_fd >= 0) close(in_fd);
+        in_fd = -1;
+    };
+    
+    // Event loop: sleep in poll() until the child exits, one of its streams
+    // has data, or the deadline passes
+    int status = 0;
+    bool exited = false;
+    int pidfd = server ? -1 : open_pidfd(pid);
+    int exit_fd = server ? server->sock : pidfd;
+    auto reap = [&](bool block) {
+        if (server) return server->reap(status, block);
+        struct rusage ru;
+        if (wait4(pid, &status, block ? 0 : WNOHANG, &ru) != pid) return false;
+#ifdef __APPLE__
+        result.max_rss = (size_t)ru.ru_maxrss;
+#else
+        // KB. Linux folds the peak of the pre-exec address space in, and
+        // that's the tester's (shared under posix_spawn, copied by fork):
+        // a value above the tester's own peak is the program's, anything
+        // else only says the program stayed below it.
+        result.max_rss = (size_t)ru.ru_maxrss * 1024;
+        struct rusage self;
+        if (getrusage(RUSAGE_SELF, &self) == 0) result.max_rss_bound = result.max_rss <= (size_t)self.ru_maxrss * 1024;
+#endif
+        task_peak_rss = max(task_peak_rss, result.max_rss);
+        result.user_ms = ru.ru_utime.tv_sec * 1000.0 + ru.ru_utime.tv_usec / 1000.0;
+        result.sys_ms = ru.ru_stime.tv_sec * 1000.0 + ru.ru_stime.tv_usec / 1000.0;
+        result.minor_faults = ru.ru_minflt;
+        result.major_faults = ru.ru_majflt;
+        result.vol_switches = ru.ru_nvcsw;
+        result.invol_switches = ru.ru_nivcsw;
+        return true;
+    };
+    string report;
+    ValgrindXml xml(result);
+    int out_fds[3] = {pipe_stdout[0], pipe_stderr[0], pipe_report[0]};
+    string* out_bufs[3] = {&result.stdout_data, &result.stderr_data, &report};
+    size_t out_seen[3] = {0, 0, 0};
+    auto deadline = start_time + chrono::seconds(timeout);
+    char buf[65536];
+    
+    while (!exited || out_fds[0] >= 0 || out_fds[1] >= 0 || out_fds[2] >= 0) {
+        auto now = chrono::high_resolution_clock::now();
+        if (now >= deadline) {
+            if (!exited) {
+                kill(pid, SIGKILL);
+                reap(true);
+                result.timed_out = true;
+            }
+            break;  // an exited child whose pipes are still held open elsewhere
+        }
+        int wait_ms = (int)chrono::ceil<chrono::milliseconds>(deadline - now).count();
+        
+        if (in_fd >= 0 && in_left == 0 && in_more) refill();
+        if (in_fd >= 0 && in_left == 0 && !in_more) close_input();
+        
+        struct pollfd pfds[5];
+        int nfds = 0;
+        for (int fd : out_fds) {
+            if (fd >= 0) pfds[nfds++] = {fd, POLLIN, 0};
+        }
+        if (in_fd >= 0) pfds[nfds++] = {in_fd, POLLOUT, 0};
+        if (!exited && exit_fd >= 0) pfds[nfds++] = {exit_fd, POLLIN, 0};
+        // Without a pidfd only closed streams hint at an exit: recheck often
+        if (!exited && exit_fd < 0 && out_fds[0] < 0 && out_fds[1] < 0 && out_fds[2] < 0) wait_ms = min(wait_ms, 1);
+        
+        if (poll(pfds, nfds, wait_ms) < 0 && errno != EINTR) break;
+        
+        // Feed stdin as far as the pipe takes it. EPIPE means the child
+        // stopped reading (exited or closed stdin): drop the rest.
+        while (in_fd >= 0 && in_left > 0) {
+            ssize_t n = write(in_fd, in_ptr, in_left);
+            if (n > 0) {
+                in_ptr += n;
+                in_left -= n;
+                if (in_left == 0 && in_more) refill();
+            } else {
+                if (n < 0 && errno != EAGAIN && errno != EINTR) close_input();
+                break;
+            }
+        }
+        
+        // Drain while the child runs so it never blocks on a full pipe.
+        // Past the cap the output can't be verified anyway: stop the child
+        // rather than buffer it or let it run into the timeout.
+        for (int i = 0; i < 3; ++i) {
+            if (out_fds[i] < 0) continue;
+            ssize_t n;
+            while ((n = read(out_fds[i], buf, sizeof(buf))) > 0) {
+                // Reports are small (shim) or parsed as they come (valgrind)
+                if (i == 2) {
+                    if (leak == LEAK_VALGRIND) xml.feed(buf, n);
+                    else report.append(buf, n);
+                    continue;
+                }
+                size_t room = cfg.max_output - min(cfg.max_output, out_seen[i]);
+                size_t keep = min((size_t)n, room);
+                out_seen[i] += keep;
+                if (i == 0 && on_stdout) {
+                    if (keep > 0 && !result.aborted && !(*on_stdout)(buf, keep)) {
+                        result.aborted = true;
+                        if (!exited) kill(pid, SIGKILL);
+                    }
+                } else {
+                    out_bufs[i]->append(buf, keep);
+                }
+                if ((size_t)n > room && !result.output_truncated) {
+                    result.output_truncated = true;
+                    if (!exited) kill(pid, SIGKILL);
+                }
+            }
+            if (n == 0 || (n < 0 && errno != EAGAIN && errno != EINTR)) {
+                close(out_fds[i]);
+                out_fds[i] = -1;
+            }
+        }
+        
+        if (!exited && reap(false)) {
+            exited = true;
+            close_input();
+            auto end_time = chrono::high_resolution_clock::now();
+            result.exec_time_ms = chrono::duration<double, milli>(end_time - start_time).count();
+        }
+    }
+    
+    close_input();
+    if (input_fd >= 0) close(input_fd);
+    if (result.timed_out) {
+        result.exec_time_ms = chrono::duration<double, milli>(chrono::high_resolution_clock::now() - start_time).count();
+    }
+    for (int fd : out_fds) if (fd >= 0) close(fd);
+    if (pidfd >= 0) close(pidfd);
+    
+    // Our own SIGKILL after truncation or an abort is not the program crashing
+    if (!result.timed_out && !result.output_truncated && !result.aborted) {
+        if (WIFEXITED(status)) {
+            result.exit_code = WEXITSTATUS(status);
+        }
+        if (WIFSIGNALED(status)) {
+            result.signal_num = WTERMSIG(status);
+        }
+    }
+    
+    if (leak == LEAK_SHIM) parse_shim_report(report, result);
+    if (leak == LEAK_VALGRIND) xml.finish();
+    
+    return result;
+}
+
+ExecResult execute_command(const vector<string>& cmd, const InputSource& input = {}, 
+                           bool with_valgrind = false, int timeout = -1) {
+    argv_arena.clear();
+    argv_arena.add(cmd);
+    return execute_argv(argv_arena, input, with_valgrind ? LEAK_VALGRIND : LEAK_NONE, timeout);
+}
+
+// ==================================================================================
+// Result Cache
+// ==================================================================================
+//
+// A run is deterministic in (binary, argv, stdin, leak checker), so results
+// are kept on disk and keyed by a SHA-256 over all four, the binary by its
+// contents. A rerun on the same build replays them instead of executing.
+// Timeouts, truncated or stopped runs and generated stdin are never cached.
+// Timings and resource usage aren't kept either, a replayed run reports
+// none: benchmark runs, which exist to measure, always execute.
+// At exit the file is rewritten with the entries this run used, so it
+// doesn't grow across builds and seeds.
+//
+// The same table memoizes within a run (on disk or not): an input that
+// comes up again in another suite is replayed, and one that is still
+// running on another worker is waited for rather than started twice.
+//
+// results.bin: "PSTC", u32 version, then per entry the 32-byte key, u32
+// length and the serialized ExecResult (see encode/decode below).
+
+// push_swap output as one op byte per line, or false if it isn't only ops
+bool encode_ops(const string& text, string& ops) {
+    ops.clear();
+    size_t start = 0;
+    while (start < text.size()) {
+        size_t nl = text.find('\n', start);
+        if (nl == string::npos) return false;
+        uint8_t op = decode_op(text.data() + start, nl - start);
+        if (op == OP_INVALID) return false;
+        ops.push_back((char)op);
+        start = nl + 1;
+    }
+    return true;
+}
+
+string decode_ops(const string& ops) {
+    string text;
+    text.reserve(ops.size() * 3);
+    for (char op : ops) {
+        text += OP_NAMES[(uint8_t)op];
+        text += '\n';
+    }
+    return text;
+}
+
+struct ResultCache {
+    static constexpr uint32_t VERSION = 4;
+    static constexpr size_t MAX_STDOUT = 16u << 20;  // bigger outputs aren't kept
+    
+    struct Entry {
+        string payload;                          // serialized result
+        bool this_run = false;                   // false: loaded from disk
+    };
+    
+    // A run in progress; other workers with the same key wait for it
+    struct Flight {
+        bool done = false;
+        bool shareable = false;                  // complete, not stopped by its sink
+        ExecResult result;
+        string out;
+        bool as_ops = false;                     // `out` is op bytes, see encode_ops
+    };
+    
+    string dir;                                  // empty = don't persist
+    mutex m;
+    condition_variable cv_flights;
+    unordered_map<string, Entry> entries;
+    unordered_map<string, shared_ptr<Flight>> flights;
+    unordered_set<string> used;
+    map<string, string> binary_hashes;           // path -> content hash, "" = unreadable
+    string valgrind_version;                     // `valgrind --version`, set by main
+    atomic<int> lookups{0}, hits{0}, saved{0};   // hits: from disk, saved: repeats in this run
+    
+    string file() const { return dir + "/results.bin"; }
+    
+    void load() {
+        if (dir.empty()) return;
+        ifstream f(file(), ios::binary);
+        char magic[4];
+        uint32_t version = 0;
+        if (!f.read(magic, 4) || memcmp(magic, "PSTC", 4) != 0 ||
+            !f.read((char*)&version, sizeof(version)) || version != VERSION) {
+            return;
+        }
+        string key(32, '\0');
+        uint32_t len;
+        while (f.read(&key[0], 32) && f.read((char*)&len, sizeof(len))) {
+            string payload(len, '\0');
+            if (!f.read(&payload[0], len)) break;
+            entries[key].payload = move(payload);
+        }
+    }
+    
+    void save() {
+        if (dir.empty() || used.empty()) return;
+        mkdir(dir.c_str(), 0755);
+        string tmp = file() + ".tmp";
+        {
+            ofstream f(tmp, ios::binary | ios::trunc);
+            f.write("PSTC", 4);
+            f.write((const char*)&VERSION, sizeof(VERSION));
+            for (const auto& key : used) {
+                const string& payload = entries[key].payload;
+                uint32_t len = (uint32_t)payload.size();
+                f.write(key.data(), 32);
+                f.write((const char*)&len, sizeof(len));
+                f.write(payload.data(), len);
+            }
+            if (!f) return;
+        }
+        rename(tmp.c_str(), file().c_str());
+    }
+    
+    string binary_hash(const string& path) {
+        {
+            lock_guard<mutex> lock(m);
+            auto it = binary_hashes.find(path);
+            if (it != binary_hashes.end()) return it->second;
+        }
+        string hash;
+        ifstream f(path, ios::binary);
+        if (f) {
+            Sha256 sha;
+            char buf[65536];
+            while (f.read(buf, sizeof(buf)) || f.gcount() > 0) sha.update(buf, f.gcount());
+            hash = sha.digest();
+        }
+        lock_guard<mutex> lock(m);
+        return binary_hashes[path] = hash;
+    }
+    
+    // False when the run can't be cached
+    bool key_for(const string& prog, const vector<string>& args, const InputSource& input,
+                 LeakCheck leak, string& key) {
+        if (input.generator) return false;
+        string bin = binary_hash(prog);
+        if (bin.empty()) return false;
+        Sha256 sha;
+        sha.field(bin);
+        sha.field(string(1, (char)leak));
+        
+        // A rebuilt shim or another valgrind may judge leaks differently
+        if (leak == LEAK_SHIM) {
+            string shim = binary_hash(cfg.leak_shim);
+            if (shim.empty()) return false;
+            sha.field(shim);
+        } else if (leak == LEAK_VALGRIND) {
+            string tool = valgrind_version;
+            for (const auto& a : VALGRIND_CMD) tool += " " + a;
+            sha.field(tool);
+        }
+        for (const auto& a : args) sha.field(a);
+        if (!input.file.empty()) {
+            string contents = binary_hash(input.file);
+            if (contents.empty()) return false;
+            sha.field("file:" + contents);
+        } else {
+            sha.field("data:" + input.data);
+        }
+        key = sha.digest();
+        return true;
+    }
+    
+    static void put(string& out, const void* p, size_t n) { out.append((const char*)p, n); }
+    template <typename T> static void put(string& out, T v) { put(out, &v, sizeof(v)); }
+    static void put_str(string& out, const string& s) {
+        put(out, (uint32_t)s.size());
+        out += s;
+    }
+    
+    // What a replay has no business reporting as its own
+    static void drop_measurements(ExecResult& r) {
+        r.exec_time_ms = r.user_ms = r.sys_ms = 0;
+        r.max_rss = 0;
+        r.max_rss_bound = false;
+        r.minor_faults = r.major_faults = r.vol_switches = r.invol_switches = 0;
+    }
+    
+    static string encode(const ExecResult& r, const string& out, bool out_is_ops) {
+        string b;
+        put(b, r.exit_code);
+        put(b, r.signal_num);
+        put(b, (uint8_t)r.has_leaks);
+        put(b, r.leaked_bytes);
+        put(b, r.leaked_blocks);
+        put(b, r.indirect_bytes);
+        put(b, r.possible_bytes);
+        put(b, r.reachable_bytes);
+        put(b, r.invalid_reads);
+        put(b, r.invalid_writes);
+        put(b, (uint8_t)r.has_errors);
+        put(b, r.error_count);
+        put(b, r.alloc_count);
+        put(b, r.peak_heap);
+        put_str(b, r.leak_summary);
+        put_str(b, r.stderr_data);
+        string ops;
+        bool as_ops = out_is_ops || encode_ops(out, ops);
+        put(b, (uint8_t)as_ops);
+        put_str(b, out_is_ops || !as_ops ? out : ops);
+        return b;
+    }
+    
+    struct Reader {
+        const string& b;
+        size_t pos = 0;
+        bool ok = true;
+        
+        void get(void* p, size_t n) {
+            if (pos + n > b.size()) {
+                ok = false;
+                memset(p, 0, n);
+                return;
+            }
+            memcpy(p, b.data() + pos, n);
+            pos += n;
+        }
+        template <typename T> T get() {
+            T v;
+            get(&v, sizeof(v));
+            return v;
+        }
+        string get_str() {
+            uint32_t n = get<uint32_t>();
+            if (!ok || pos + n > b.size()) {
+                ok = false;
+                return "";
+            }
+            pos += n;
+            return b.substr(pos - n, n);
+        }
+    };
+    
+    // `out` comes back as stored: op bytes when `as_ops`
+    static bool decode(const string& b, ExecResult& r, string& out, bool& as_ops) {
+        Reader in{b};
+        r.exit_code = in.get<int>();
+        r.signal_num = in.get<int>();
+        r.has_leaks = in.get<uint8_t>();
+        r.leaked_bytes = in.get<int64_t>();
+        r.leaked_blocks = in.get<int64_t>();
+        r.indirect_bytes = in.get<int64_t>();
+        r.possible_bytes = in.get<int64_t>();
+        r.reachable_bytes = in.get<int64_t>();
+        r.invalid_reads = in.get<int>();
+        r.invalid_writes = in.get<int>();
+        r.has_errors = in.get<uint8_t>();
+        r.error_count = in.get<int>();
+        r.alloc_count = in.get<long long>();
+        r.peak_heap = in.get<long long>();
+        r.leak_summary = in.get_str();
+        r.stderr_data = in.get_str();
+        as_ops = in.get<uint8_t>();
+        out = in.get_str();
+        return in.ok;
+    }
+    
+    // A known result for `key`, possibly after waiting for the run in
+    // flight. Otherwise the caller is registered as running it and must
+    // finish() the key.
+    bool acquire(const string& key, ExecResult& r, string& out, bool& as_ops) {
+        lookups++;
+        unique_lock<mutex> lock(m);
+        while (true) {
+            auto it = entries.find(key);
+            if (it != entries.end() && decode(it->second.payload, r, out, as_ops)) {
+                used.insert(key);
+                (it->second.this_run ? saved : hits)++;
+                return true;
+            }
+            auto f = flights.find(key);
+            if (f == flights.end()) break;
+            shared_ptr<Flight> flight = f->second;
+            cv_flights.wait(lock, [&] { return flight->done; });
+            if (flight->shareable) {
+                r = flight->result;
+                out = flight->out;
+                as_ops = flight->as_ops;
+                saved++;
+                return true;
+            }
+            // Stopped early, its output is no use here: run it ourselves
+        }
+        flights[key] = make_shared<Flight>();
+        return false;
+    }
+    
+    // Publishes the run registered by acquire(); `storable` results are kept
+    void finish(const string& key, const ExecResult& r, const string& out, bool as_ops,
+                bool shareable, bool storable) {
+        string payload = storable ? encode(r, out, as_ops) : "";
+        lock_guard<mutex> lock(m);
+        if (storable) {
+            entries[key] = {move(payload), true};
+            used.insert(key);
+        }
+        auto f = flights.find(key);
+        if (f != flights.end()) {
+            f->second->done = true;
+            f->second->shareable = shareable;
+            if (shareable) {
+                f->second->result = r;
+                f->second->result.stdout_data.clear();
+                drop_measurements(f->second->result);
+                f->second->out = out;
+                f->second->as_ops = as_ops;
+            }
+            flights.erase(f);
+        }
+        cv_flights.notify_all();
+    }
+};
+
+ResultCache result_cache;
+
+// Op bytes of streamed output, built as it arrives so a run consumed by a
+// sink can be cached without keeping its text. Gives up on anything that
+// isn't one op per line; the cache then doesn't keep the run.
+struct OpRecorder {
+    string ops;
+    string line;
+    bool ok = true;
+    
+    void feed(const char* data, size_t len) {
+        for (size_t i = 0; i < len && ok; ++i) {
+            if (data[i] != '\n') {
+                line += data[i];
+                ok = line.size() <= 3;
+                continue;
+            }
+            uint8_t op = decode_op(line.data(), line.size());
+            ok = op != OP_INVALID && ops.size() < ResultCache::MAX_STDOUT;
+            ops.push_back((char)op);
+            line.clear();
+        }
+    }
+    
+    bool complete() const { return ok && line.empty(); }
+};
+
+// Test programs go straight into the arena, no intermediate command vector.
+// Results come from the cache when possible, a cached stdout is replayed
+// into `on_stdout` like a live one.
+ExecResult run_program(const string& prog, const vector<string>& args,
+                       const InputSource& input, bool with_valgrind,
+                       const OutputSink* on_stdout = nullptr, bool measured = false) {
+    LeakCheck leak = LEAK_NONE;
+    if (with_valgrind && cfg.use_valgrind) leak = cfg.leak_shim.empty() ? LEAK_VALGRIND : LEAK_SHIM;
+    
+    // Measured runs are there for their timings: never replayed
+    string key, cached_out;
+    bool cacheable = !measured && result_cache.key_for(prog, args, input, leak, key);
+    if (cacheable) {
+        ExecResult cached;
+        bool as_ops = false;
+        if (result_cache.acquire(key, cached, cached_out, as_ops)) {
+            if (!on_stdout) {
+                cached.stdout_data = as_ops ? decode_ops(cached_out) : move(cached_out);
+                return cached;
+            }
+            // Op bytes go back to text a chunk at a time
+            string chunk;
+            for (size_t pos = 0; pos < cached_out.size() && !cached.aborted;) {
+                size_t n = min((size_t)(as_ops ? 16384 : 65536), cached_out.size() - pos);
+                if (as_ops) {
+                    chunk.clear();
+                    for (size_t i = pos; i < pos + n; ++i) {
+                        chunk += OP_NAMES[(uint8_t)cached_out[i]];
+                        chunk += '\n';
+                    }
+                } else {
+                    chunk.assign(cached_out, pos, n);
+                }
+                pos += n;
+                cached.aborted = !(*on_stdout)(chunk.data(), chunk.size());
+            }
+            return cached;
+        }
     }
-    cmd.insert(cmd.end(), args.begin(), args.end());
-    return execute_command(cmd, instructions, with_valgrind);
+    
+    // A sink consumes stdout as it comes: record its ops for the cache
+    OpRecorder recorder;
+    OutputSink tee;
+    const OutputSink* sink = on_stdout;
+    if (cacheable && on_stdout) {
+        tee = [&](const char* data, size_t len) {
+            recorder.feed(data, len);
+            return (*on_stdout)(data, len);
+        };
+        sink = &tee;
+    }
+    
+    argv_arena.clear();
+    if (leak == LEAK_VALGRIND) argv_arena.add(VALGRIND_CMD);
+    argv_arena.add(prog);
+    argv_arena.add(args);
+    ExecResult r = execute_argv(argv_arena, input, leak, -1, leak != LEAK_NONE ? nullptr : fork_server_for(prog), sink);
+    
+    if (cacheable) {
+        const string& out = on_stdout ? recorder.ops : r.stdout_data;
+        bool shareable = (!on_stdout || recorder.complete()) && !r.aborted;
+        bool storable = shareable && out.size() <= ResultCache::MAX_STDOUT && r.exit_code >= 0 &&
+                        !r.timed_out && !r.output_truncated;
+        result_cache.finish(key, r, out, on_stdout != nullptr, shareable, storable);
+    }
+    return r;
+}
+
+ExecResult run_push_swap(const vector<string>& args, bool with_valgrind = false,
+                         const OutputSink* on_stdout = nullptr, bool measured = false) {
+    return run_program(cfg.push_swap, args, {}, with_valgrind, on_stdout, measured);
+}
+
+ExecResult run_checker(const vector<string>& args, const InputSource& instructions, bool with_valgrind = false) {
+    return run_program(cfg.checker, args, instructions, with_valgrind);
 }
 
 // ==================================================================================
 // Stack Simulation (for operation validation)
 // ==================================================================================
 
-class StackSimulator {
+// Straightforward reference version, kept for --sim-bench
+class StackSimulator {
+public:
+    deque<int> a, b;
+    
+    void init(const vector<int>& nums) {
+        a.clear();
+        b.clear();
+        for (int n : nums) a.push_back(n);
+    }
+    
+    void execute(uint8_t op) {
+        switch (op) {
+            case SA: if (a.size() >= 2) swap(a[0], a[1]); break;
+            case SB: if (b.size() >= 2) swap(b[0], b[1]); break;
+            case SS: execute(SA); execute(SB); break;
+            case PA: if (!b.empty()) { a.push_front(b.front()); b.pop_front(); } break;
+            case PB: if (!a.empty()) { b.push_front(a.front()); a.pop_front(); } break;
+            case RA: if (a.size() >= 2) { a.push_back(a.front()); a.pop_front(); } break;
+            case RB: if (b.size() >= 2) { b.push_back(b.front()); b.pop_front(); } break;
+            case RR: execute(RA); execute(RB); break;
+            case RRA: if (a.size() >= 2) { a.push_front(a.back()); a.pop_back(); } break;
+            case RRB: if (b.size() >= 2) { b.push_front(b.back()); b.pop_back(); } break;
+            case RRR: execute(RRA); execute(RRB); break;
+        }
+    }
+    
+    void execute_all(const vector<uint8_t>& ops) {
+        for (uint8_t op : ops) execute(op);
+    }
+    
+    bool is_sorted() const {
+        if (!b.empty()) return false;
+        for (size_t i = 1; i < a.size(); ++i) {
+            if (a[i] < a[i-1]) return false;
+        }
+        return true;
+    }
+};
+
+// Values are replaced by their rank (0..n-1) and both stacks live in one
+// allocation: two power-of-two rings of 32-bit ranks with head index and
+// size, so every op is a couple of masked loads/stores. The dense opcode
+// switch compiles to a jump table, with the ring state held in registers.
+class RingSimulator {
+public:
+    void init(const vector<int>& nums) {
+        n = nums.size();
+        cap = 1;
+        while (cap < n) cap <<= 1;
+        mask = cap - 1;
+        buf.assign(2 * cap, 0);
+        a = buf.data();
+        b = buf.data() + cap;
+        
+        // Sort (value, position) pairs once; equal values share a rank
+        vector<pair<int, uint32_t>> order(n);
+        for (size_t i = 0; i < n; ++i) order[i] = {nums[i], (uint32_t)i};
+        sort(order.begin(), order.end());
+        uint32_t r = 0;
+        for (size_t i = 0; i < n; ++i) {
+            if (i > 0 && order[i].first != order[i - 1].first) r = (uint32_t)i;
+            a[order[i].second] = r;
+        }
+        a_head = 0;
+        a_size = n;
+        b_head = 0;
+        b_size = 0;
+    }
+    
+    void execute_all(const vector<uint8_t>& ops) { execute_all(ops.data(), ops.size()); }
+    
+    void execute_all(const uint8_t* ops, size_t count) {
+        uint32_t* A = a;
+        uint32_t* B = b;
+        size_t m = mask, ah = a_head, as = a_size, bh = b_head, bs = b_size;
+        for (size_t i = 0; i < count; ++i) {
+            switch (ops[i]) {
+                case SA: if (as >= 2) swap(A[ah], A[(ah + 1) & m]); break;
+                case SB: if (bs >= 2) swap(B[bh], B[(bh + 1) & m]); break;
+                case SS:
+                    if (as >= 2) swap(A[ah], A[(ah + 1) & m]);
+                    if (bs >= 2) swap(B[bh], B[(bh + 1) & m]);
+                    break;
+                case PA:
+                    if (bs == 0) break;
+                    ah = (ah - 1) & m;
+                    A[ah] = B[bh];
+                    bh = (bh + 1) & m;
+                    bs--; as++;
+                    break;
+                case PB:
+                    if (as == 0) break;
+                    bh = (bh - 1) & m;
+                    B[bh] = A[ah];
+                    ah = (ah + 1) & m;
+                    as--; bs++;
+                    break;
+                case RA: if (as >= 2) { A[(ah + as) & m] = A[ah]; ah = (ah + 1) & m; } break;
+                case RB: if (bs >= 2) { B[(bh + bs) & m] = B[bh]; bh = (bh + 1) & m; } break;
+                case RR:
+                    if (as >= 2) { A[(ah + as) & m] = A[ah]; ah = (ah + 1) & m; }
+                    if (bs >= 2) { B[(bh + bs) & m] = B[bh]; bh = (bh + 1) & m; }
+                    break;
+                case RRA: if (as >= 2) { ah = (ah - 1) & m; A[ah] = A[(ah + as) & m]; } break;
+                case RRB: if (bs >= 2) { bh = (bh - 1) & m; B[bh] = B[(bh + bs) & m]; } break;
+                case RRR:
+                    if (as >= 2) { ah = (ah - 1) & m; A[ah] = A[(ah + as) & m]; }
+                    if (bs >= 2) { bh = (bh - 1) & m; B[bh] = B[(bh + bs) & m]; }
+                    break;
+            }
+        }
+        a_head = ah; a_size = as; b_head = bh; b_size = bs;
+    }
+    
+    bool is_sorted() const {
+        if (b_size != 0) return false;
+        // A is at most two contiguous runs: [a_head, cap) and [0, wrap)
+        size_t first = min(a_size, cap - a_head);
+        const uint32_t* p = a + a_head;
+        if (!ascending(p, first)) return false;
+        if (first == a_size) return true;
+        return p[first - 1] <= a[0] && ascending(a, a_size - first);
+    }
+    
+    // Ranks in each stack, top first (for cross-checking)
+    vector<uint32_t> stack_a() const { return linear(a, a_head, a_size); }
+    vector<uint32_t> stack_b() const { return linear(b, b_head, b_size); }
+
+private:
+    vector<uint32_t> buf;
+    uint32_t* a = nullptr;
+    uint32_t* b = nullptr;
+    size_t n = 0, cap = 0, mask = 0;
+    size_t a_head = 0, a_size = 0, b_head = 0, b_size = 0;
+    
+    vector<uint32_t> linear(const uint32_t* ring, size_t head, size_t size) const {
+        vector<uint32_t> out(size);
+        for (size_t i = 0; i < size; ++i) out[i] = ring[(head + i) & mask];
+        return out;
+    }
+    
+    // Branch-free so the compiler turns it into SIMD compares
+    static bool ascending(const uint32_t* p, size_t len) {
+        uint32_t bad = 0;
+        for (size_t i = 1; i < len; ++i) bad |= (p[i] < p[i - 1]);
+        return bad == 0;
+    }
+};
+
+// Checks push_swap's stdout while it is still being written: each chunk is
+// decoded and applied to a RingSimulator right away, with a partial line
+// carried over to the next chunk. Memory stays O(n) however long the output.
+// With `early_kill`, feed() returns false (stop the child) at the first
+// invalid instruction or once the op count passes `budget` (0 = none).
+class StreamVerifier {
 public:
-    deque<int> a, b;
+    StreamVerifier(const vector<int>& nums, bool early_kill = false, int budget = 0)
+        : early_kill(early_kill), budget(budget) {
+        sim.init(nums);
+    }
     
-    void init(const vector<int>& nums) {
-        a.clear();
-        b.clear();
-        for (int n : nums) a.push_back(n);
+    bool feed(const char* data, size_t len) {
+        const char* end = data + len;
+        while (data < end && valid) {
+            const char* nl = (const char*)memchr(data, '\n', end - data);
+            if (!nl) {
+                // Keep enough of an unfinished line to decode or report it
+                size_t take = min((size_t)(end - data), MAX_LINE - min(MAX_LINE, partial.size()));
+                partial.append(data, take);
+                partial_len += end - data;
+                break;
+            }
+            if (partial_len == 0) {
+                take_line(data, nl - data);
+            } else {
+                partial.append(data, min((size_t)(nl - data), MAX_LINE - min(MAX_LINE, partial.size())));
+                partial_len += nl - data;
+                take_line(partial.data(), partial_len);
+                partial.clear();
+                partial_len = 0;
+            }
+            data = nl + 1;
+        }
+        flush();
+        if (budget > 0 && op_count > budget) over_budget = true;
+        return !early_kill || (valid && !over_budget);
     }
     
-    bool execute(const string& op) {
-        if (op == "sa") { if (a.size() >= 2) swap(a[0], a[1]); }
-        else if (op == "sb") { if (b.size() >= 2) swap(b[0], b[1]); }
-        else if (op == "ss") { execute("sa"); execute("sb"); }
-        else if (op == "pa") { if (!b.empty()) { a.push_front(b.front()); b.pop_front(); } }
-        else if (op == "pb") { if (!a.empty()) { b.push_front(a.front()); a.pop_front(); } }
-        else if (op == "ra") { if (a.size() >= 2) { a.push_back(a.front()); a.pop_front(); } }
-        else if (op == "rb") { if (b.size() >= 2) { b.push_back(b.front()); b.pop_front(); } }
-        else if (op == "rr") { execute("ra"); execute("rb"); }
-        else if (op == "rra") { if (a.size() >= 2) { a.push_front(a.back()); a.pop_back(); } }
-        else if (op == "rrb") { if (b.size() >= 2) { b.push_front(b.back()); b.pop_back(); } }
-        else if (op == "rrr") { execute("rra"); execute("rrb"); }
-        else return false;
-        return true;
+    // The last line may lack its newline
+    void finish() {
+        if (valid && partial_len > 0) take_line(partial.data(), partial_len);
+        partial.clear();
+        partial_len = 0;
+        flush();
     }
     
-    bool execute_all(const string& instructions) {
-        istringstream iss(instructions);
-        string op;
-        while (getline(iss, op)) {
-            if (op.empty()) continue;
-            if (!execute(op)) return false;
+    bool is_valid() const { return valid; }
+    bool is_over_budget() const { return over_budget; }
+    bool is_sorted() const { return valid && sim.is_sorted(); }
+    int count() const { return op_count; }
+    string error() const { return invalid_op_message(bad_text, line, bad_offset); }
+    
+    // Keeps the decoded ops too, one byte each (see decode_ops)
+    void keep_ops() { keeping = true; }
+    const string& ops() const { return kept; }
+    
+    // The kept ops as push_swap printed them, up to and including the line
+    // that made the output invalid (at most MAX_LINE bytes of it)
+    string output() const {
+        string text = decode_ops(kept);
+        if (!valid) text += bad_text + (bad_text.size() == MAX_LINE ? "...\n" : "\n");
+        return text;
+    }
+
+private:
+    static constexpr size_t MAX_LINE = 32;  // longer can't be an op, only reported
+    RingSimulator sim;
+    bool early_kill;
+    int budget;
+    uint8_t batch[4096];
+    size_t batched = 0;
+    string partial;
+    size_t partial_len = 0;  // full length, `partial` keeps at most MAX_LINE
+    size_t line = 0;
+    size_t offset = 0;       // of the current line in the whole output
+    size_t bad_offset = 0;
+    string bad_text;
+    int op_count = 0;
+    bool valid = true;
+    bool over_budget = false;
+    bool keeping = false;
+    string kept;
+    
+    void take_line(const char* p, size_t len) {
+        line++;
+        if (len > 0) {
+            uint8_t op = (len <= MAX_LINE) ? decode_op(p, len) : (uint8_t)OP_INVALID;
+            if (op == OP_INVALID) {
+                valid = false;
+                bad_offset = offset;
+                bad_text.assign(p, min(len, MAX_LINE));
+                return;
+            }
+            batch[batched++] = op;
+            if (keeping) kept.push_back((char)op);
+            op_count++;
+            if (batched == sizeof(batch)) flush();
         }
-        return true;
+        offset += len + 1;
     }
     
-    bool is_sorted() const {
-        if (!b.empty()) return false;
-        for (size_t i = 1; i < a.size(); ++i) {
-            if (a[i] < a[i-1]) return false;
-        }
-        return true;
+    void flush() {
+        sim.execute_all(batch, batched);
+        batched = 0;
     }
 };
 
-bool verify_sort(const vector<int>& nums, const string& instructions) {
-    StackSimulator sim;
-    sim.init(nums);
-    if (!sim.execute_all(instructions)) return false;
-    return sim.is_sorted();
-}
-
 // ==================================================================================
 // Pretty Printing
 // ==================================================================================
 
+// Headers are issued by the suites between submissions, so they go through
+// the pool to land between the right results
 void print_header(const string& title) {
-    cout << "\n" << BLD << BLU;
-    cout << "╔══════════════════════════════════════════════════════════════════╗\n";
-    cout << "║ " << left << setw(65) << title << "║\n";
-    cout << "╚══════════════════════════════════════════════════════════════════╝" << RST << "\n";
+    pool.ordered([=] {
+        cout << "\n" << BLD << BLU;
+        cout << "╔══════════════════════════════════════════════════════════════════╗\n";
+        cout << "║ " << left << setw(65) << title << "║\n";
+        cout << "╚══════════════════════════════════════════════════════════════════╝" << RST << "\n";
+    });
 }
 
 void print_subheader(const string& title) {
-    cout << "\n" << BLD << CYN << "▶ " << title << RST << "\n";
-    cout << GRY << string(70, '-') << RST << "\n";
+    pool.ordered([=] {
+        cout << "\n" << BLD << CYN << "▶ " << title << RST << "\n";
+        cout << GRY << string(70, '-') << RST << "\n";
+    });
 }
 
 void print_result(const string& name, const string& status, const string& details = "") {
@@ -593,6 +2949,13 @@ void print_result(const string& name, const string& status, const string& detail
     cout << "\n";
 }
 
+// Prints a pooled test once it has been committed
+void print_result(const string& name, const TestHandle& r, bool show_ops = false) {
+    pool.ordered([=] {
+        print_result(name, r->status, show_ops ? to_string(r->instruction_count) + " ops" : "");
+    });
+}
+
 void print_progress(int current, int total, const string& prefix = "") {
     int width = 40;
     int filled = (current * width) / total;
@@ -612,204 +2975,232 @@ void clear_line() {
 // Test Functions
 // ==================================================================================
 
-TestResult test_error_case(const string& name, const vector<string>& args, bool check_leaks = true) {
-    TestResult result;
-    result.name = name;
-    result.category = "Error Handling";
-    
-    result.exec = run_push_swap(args, check_leaks && cfg.use_valgrind);
-    
-    // Check for "Error" in stderr
-    bool has_error = (result.exec.stderr_data.find("Error") != string::npos);
-    
-    // Some implementations print to stdout
-    if (!has_error) {
-        has_error = (result.exec.stdout_data.find("Error") != string::npos);
-    }
-    
-    // Check leaks FIRST - a leak is ALWAYS a failure, even if output is correct!
-    bool has_leak = (check_leaks && cfg.use_valgrind && result.exec.has_leaks);
-    
-    if (has_leak) {
-        result.passed = false;
-        result.status = LEAK;
-        result.details = to_string(result.exec.leaked_bytes) + " bytes leaked";
-        if (!has_error) result.details += " + Expected 'Error' on stderr";
-        stats.leaks++;
-    } else if (has_error) {
-        result.passed = true;
-        result.status = PASS;
-    } else if (result.exec.timed_out) {
-        result.passed = false;
-        result.status = TOUT;
-        stats.timeouts++;
-    } else if (result.exec.signal_num == SIGSEGV) {
-        result.passed = false;
-        result.status = SEGV;
-        stats.crashes++;
-    } else if (result.exec.signal_num == SIGABRT) {
-        result.passed = false;
-        result.status = RED "ABORT" RST;
-        stats.crashes++;
-    } else {
-        result.passed = false;
-        result.status = FAIL;
-        result.details = "Expected 'Error' on stderr";
-    }
+TestHandle test_error_case(const string& name, const vector<string>& args, bool check_leaks = true) {
+    auto result = make_shared<TestResult>();
+    result->name = name;
+    result->category = "Error Handling";
     
-    stats.total++;
-    if (result.passed) stats.passed++;
-    else {
-        stats.failed++;
-        stats.failed_tests.push_back(name);
-        log_trace(name, args, result.details);
-        log_error(name, "Error Handling", result.details, args);
-    }
+    bool with_valgrind = check_leaks && cfg.use_valgrind;
     
-    all_results.push_back(result);
+    pool.submit([=] { result->exec = run_push_swap(args, with_valgrind); }, [=] {
+        // Check for "Error" in stderr
+        bool has_error = (result->exec.stderr_data.find("Error") != string::npos);
+        
+        // Some implementations print to stdout
+        if (!has_error) {
+            has_error = (result->exec.stdout_data.find("Error") != string::npos);
+        }
+        
+        // Check leaks FIRST - a leak is ALWAYS a failure, even if output is correct!
+        bool has_leak = (check_leaks && cfg.use_valgrind && result->exec.has_leaks);
+        
+        if (has_leak) {
+            result->passed = false;
+            result->status = LEAK;
+            result->details = to_string(result->exec.leaked_bytes) + " bytes leaked";
+            if (!has_error) result->details += " + Expected 'Error' on stderr";
+            stats.leaks++;
+        } else if (has_error) {
+            result->passed = true;
+            result->status = PASS;
+        } else if (result->exec.timed_out) {
+            result->passed = false;
+            result->status = TOUT;
+            stats.timeouts++;
+        } else if (result->exec.signal_num == SIGSEGV) {
+            result->passed = false;
+            result->status = SEGV;
+            stats.crashes++;
+        } else if (result->exec.signal_num == SIGABRT) {
+            result->passed = false;
+            result->status = RED "ABORT" RST;
+            stats.crashes++;
+        } else {
+            result->passed = false;
+            result->status = FAIL;
+            result->details = "Expected 'Error' on stderr";
+        }
+        
+        stats.total++;
+        if (result->passed) stats.passed++;
+        else {
+            stats.failed++;
+            stats.failed_tests.push_back(name);
+            log_trace(name, args, result->details);
+            log_error(name, "Error Handling", result->details + leak_report(result->exec) + usage_report(result->exec) +
+                      spill_output(*result), args);
+        }
+        
+        record_result(*result);
+    }, valgrind_job(with_valgrind, args.size()));
     return result;
 }
 
-TestResult test_empty_case(const string& name, const vector<string>& args, bool check_leaks = true) {
-    TestResult result;
-    result.name = name;
-    result.category = "Empty/No Output";
-    
-    result.exec = run_push_swap(args, check_leaks && cfg.use_valgrind);
-    
-    // When valgrind is running, stderr contains valgrind output, not program output
-    // So we need to check if the program's actual stderr is empty
-    // Valgrind output starts with "==" so we can detect it
-    bool stderr_is_program_output = result.exec.stderr_data.empty() ||
-        (check_leaks && cfg.use_valgrind && 
-         result.exec.stderr_data.find("==") != string::npos &&
-         result.exec.stderr_data.find("Error") == string::npos);
-    
-    // Should output nothing and exit cleanly
-    bool clean_exit = (result.exec.exit_code == 0 && 
-                       result.exec.stdout_data.empty() && 
-                       stderr_is_program_output);
-    
-    // Also accept "Error" for edge cases like empty string
-    bool error_exit = (result.exec.stderr_data.find("Error") != string::npos);
-    
-    // Check leaks FIRST - a leak is ALWAYS a failure!
-    bool has_leak = (check_leaks && cfg.use_valgrind && result.exec.has_leaks);
-    
-    if (has_leak) {
-        result.passed = false;
-        result.status = LEAK;
-        result.details = to_string(result.exec.leaked_bytes) + " bytes leaked";
-        if (!clean_exit && !error_exit) result.details += " + Expected empty output or 'Error'";
-        stats.leaks++;
-    } else if (clean_exit || error_exit) {
-        result.passed = true;
-        result.status = PASS;
-    } else if (result.exec.timed_out) {
-        result.passed = false;
-        result.status = TOUT;
-        stats.timeouts++;
-    } else if (result.exec.signal_num != 0) {
-        result.passed = false;
-        result.status = (result.exec.signal_num == SIGSEGV) ? SEGV : RED "CRASH" RST;
-        stats.crashes++;
-    } else {
-        result.passed = false;
-        result.status = FAIL;
-        result.details = "Expected empty output or 'Error'";
-    }
-    
-    stats.total++;
-    if (result.passed) stats.passed++;
-    else {
-        stats.failed++;
-        stats.failed_tests.push_back(name);
-        log_trace(name, args, result.details);
-        log_error(name, "Empty/No Output", result.details, args);
-    }
-    
-    all_results.push_back(result);
+TestHandle test_empty_case(const string& name, const vector<string>& args, bool check_leaks = true) {
+    auto result = make_shared<TestResult>();
+    result->name = name;
+    result->category = "Empty/No Output";
+    
+    bool with_valgrind = check_leaks && cfg.use_valgrind;
+    
+    pool.submit([=] { result->exec = run_push_swap(args, with_valgrind); }, [=] {
+        // Should output nothing and exit cleanly (valgrind reports elsewhere,
+        // stderr is the program's own)
+        bool clean_exit = (result->exec.exit_code == 0 && 
+                           result->exec.stdout_data.empty() && 
+                           result->exec.stderr_data.empty());
+        
+        // Also accept "Error" for edge cases like empty string
+        bool error_exit = (result->exec.stderr_data.find("Error") != string::npos);
+        
+        // Check leaks FIRST - a leak is ALWAYS a failure!
+        bool has_leak = (check_leaks && cfg.use_valgrind && result->exec.has_leaks);
+        
+        if (has_leak) {
+            result->passed = false;
+            result->status = LEAK;
+            result->details = to_string(result->exec.leaked_bytes) + " bytes leaked";
+            if (!clean_exit && !error_exit) result->details += " + Expected empty output or 'Error'";
+            stats.leaks++;
+        } else if (clean_exit || error_exit) {
+            result->passed = true;
+            result->status = PASS;
+        } else if (result->exec.timed_out) {
+            result->passed = false;
+            result->status = TOUT;
+            stats.timeouts++;
+        } else if (result->exec.signal_num != 0) {
+            result->passed = false;
+            result->status = (result->exec.signal_num == SIGSEGV) ? SEGV : RED "CRASH" RST;
+            stats.crashes++;
+        } else {
+            result->passed = false;
+            result->status = FAIL;
+            result->details = "Expected empty output or 'Error'";
+        }
+        
+        stats.total++;
+        if (result->passed) stats.passed++;
+        else {
+            stats.failed++;
+            stats.failed_tests.push_back(name);
+            log_trace(name, args, result->details);
+            log_error(name, "Empty/No Output", result->details + leak_report(result->exec) + usage_report(result->exec) +
+                      spill_output(*result), args);
+        }
+        
+        record_result(*result);
+    }, valgrind_job(with_valgrind, args.size()));
     return result;
 }
 
-TestResult test_sort_case(const string& name, const vector<int>& nums, bool check_leaks = true) {
-    TestResult result;
-    result.name = name;
-    result.category = "Sorting";
+// `seed` is what generated `nums`, if anything, for errors.txt
+TestHandle test_sort_case(const string& name, const vector<int>& nums, bool check_leaks = true,
+                          uint64_t seed = 0) {
+    auto result = make_shared<TestResult>();
+    result->name = name;
+    result->category = "Sorting";
+    result->seed = seed;
     
     vector<string> args;
     for (int n : nums) args.push_back(to_string(n));
     
-    result.exec = run_push_swap(args, check_leaks && cfg.use_valgrind);
-    
-    // Check leaks FIRST - a leak is ALWAYS a failure!
-    bool has_leak = (check_leaks && cfg.use_valgrind && result.exec.has_leaks);
-    
-    if (has_leak) {
-        result.passed = false;
-        result.status = LEAK;
-        result.details = to_string(result.exec.leaked_bytes) + " bytes leaked";
-        result.instruction_count = count_instructions(result.exec.stdout_data);
-        stats.leaks++;
-    } else if (result.exec.timed_out) {
-        result.passed = false;
-        result.status = TOUT;
-        stats.timeouts++;
-    } else if (result.exec.signal_num == SIGSEGV) {
-        result.passed = false;
-        result.status = SEGV;
-        stats.crashes++;
-    } else if (result.exec.signal_num != 0) {
-        result.passed = false;
-        result.status = RED "CRASH" RST;
-        stats.crashes++;
-    } else {
-        // Validate instructions
-        if (!validate_all_instructions(result.exec.stdout_data)) {
-            result.passed = false;
-            result.status = FAIL;
-            result.details = "Invalid instruction(s)";
+    bool with_valgrind = check_leaks && cfg.use_valgrind;
+    
+    // Verification streams alongside the run on the worker, only the
+    // bookkeeping happens in the (serialized) commit
+    struct SortCheck {
+        bool valid = true;
+        bool sorted = false;
+        int ops = 0;
+        string error;
+        bool checked = false;     // the checker gave a second opinion
+        bool checker_ok = false;
+    };
+    auto check = make_shared<SortCheck>();
+    
+    pool.submit([=] {
+        StreamVerifier verifier(nums, cfg.early_kill);
+        verifier.keep_ops();
+        OutputSink sink = [&verifier](const char* data, size_t len) { return verifier.feed(data, len); };
+        ExecResult& r = result->exec = run_push_swap(args, with_valgrind, &sink);
+        verifier.finish();
+        check->valid = verifier.is_valid();
+        check->sorted = verifier.is_sorted();
+        check->ops = verifier.count();
+        if (!check->valid) check->error = verifier.error();
+        
+        // Try with checker if available
+        bool completed = !r.timed_out && r.signal_num == 0 && !r.output_truncated;
+        if (completed && check->valid && !check->sorted && !cfg.checker.empty()) {
+            ExecResult chk = run_checker(args, decode_ops(verifier.ops()));
+            check->checked = true;
+            check->checker_ok = chk.stdout_data.find("OK") != string::npos;
+        }
+        
+        // stdout went to the verifier: a failure gets it back for the spill
+        // file and the record's digest
+        bool leaked = with_valgrind && r.has_leaks;
+        if (!completed || leaked || !(check->sorted || check->checker_ok)) r.stdout_data = verifier.output();
+    }, [=] {
+        // Check leaks FIRST - a leak is ALWAYS a failure!
+        bool has_leak = (check_leaks && cfg.use_valgrind && result->exec.has_leaks);
+        
+        if (has_leak) {
+            result->passed = false;
+            result->status = LEAK;
+            result->details = to_string(result->exec.leaked_bytes) + " bytes leaked";
+            result->instruction_count = check->ops;
+            stats.leaks++;
+        } else if (result->exec.timed_out) {
+            result->passed = false;
+            result->status = TOUT;
+            stats.timeouts++;
+        } else if (result->exec.signal_num == SIGSEGV) {
+            result->passed = false;
+            result->status = SEGV;
+            stats.crashes++;
+        } else if (result->exec.signal_num != 0) {
+            result->passed = false;
+            result->status = RED "CRASH" RST;
+            stats.crashes++;
+        } else if (result->exec.output_truncated) {
+            result->passed = false;
+            result->status = FAIL;
+            result->details = "Output exceeded " + format_bytes(cfg.max_output);
         } else {
-            // Verify sorting
-            bool sorted = verify_sort(nums, result.exec.stdout_data);
-            result.instruction_count = count_instructions(result.exec.stdout_data);
-            
-            if (sorted) {
-                result.passed = true;
-                result.status = PASS;
-                result.details = to_string(result.instruction_count) + " ops";
+            // Validate instructions
+            if (!check->valid) {
+                result->passed = false;
+                result->status = FAIL;
+                result->details = check->error;
             } else {
-                // Try with checker if available
-                if (!cfg.checker.empty()) {
-                    ExecResult chk = run_checker(args, result.exec.stdout_data);
-                    if (chk.stdout_data.find("OK") != string::npos) {
-                        result.passed = true;
-                        result.status = PASS;
-                        result.details = to_string(result.instruction_count) + " ops";
-                    } else {
-                        result.passed = false;
-                        result.status = FAIL;
-                        result.details = "Checker: KO";
-                    }
+                result->instruction_count = check->ops;
+                
+                if (check->sorted || check->checker_ok) {
+                    result->passed = true;
+                    result->status = PASS;
+                    result->details = to_string(result->instruction_count) + " ops";
                 } else {
-                    result.passed = false;
-                    result.status = FAIL;
-                    result.details = "Not sorted";
+                    result->passed = false;
+                    result->status = FAIL;
+                    result->details = check->checked ? "Checker: KO" : "Not sorted";
                 }
             }
         }
-    }
-    
-    stats.total++;
-    if (result.passed) stats.passed++;
-    else {
-        stats.failed++;
-        stats.failed_tests.push_back(name);
-        log_trace(name, args, result.details);
-        log_error(name, "Sorting", result.details, args);
-    }
-    
-    all_results.push_back(result);
+        
+        stats.total++;
+        if (result->passed) stats.passed++;
+        else {
+            stats.failed++;
+            stats.failed_tests.push_back(name);
+            log_trace(name, args, result->details);
+            log_error(name, "Sorting", result->details + leak_report(result->exec) + usage_report(result->exec) +
+                      spill_output(*result), args, seed);
+        }
+        
+        record_result(*result);
+    }, valgrind_job(with_valgrind, nums.size()));
     return result;
 }
 
@@ -823,227 +3214,227 @@ void run_parsing_tests() {
     print_subheader("Empty/No Arguments");
     // No arguments - should display nothing
     print_result("No arguments", 
-                 test_empty_case("No arguments", {}).status);
+                 test_empty_case("No arguments", {}));
     print_result("Empty string \"\"", 
-                 test_empty_case("Empty string \"\"", {""}).status);
+                 test_empty_case("Empty string \"\"", {""}));
     print_result("Just spaces \"   \"", 
-                 test_error_case("Just spaces", {"   "}).status);
+                 test_error_case("Just spaces", {"   "}));
     print_result("Multiple empty strings", 
-                 test_error_case("Multiple empty strings", {"", ""}).status);
+                 test_error_case("Multiple empty strings", {"", ""}));
     print_result("Tab character", 
-                 test_error_case("Tab character", {"\t"}).status);
+                 test_error_case("Tab character", {"\t"}));
     print_result("Newline character", 
-                 test_error_case("Newline character", {"\n"}).status);
+                 test_error_case("Newline character", {"\n"}));
     
     print_subheader("Invalid Characters");
     print_result("Letter 'a'", 
-                 test_error_case("Letter 'a'", {"a"}).status);
+                 test_error_case("Letter 'a'", {"a"}));
     print_result("Letters 'abc'", 
-                 test_error_case("Letters 'abc'", {"abc"}).status);
+                 test_error_case("Letters 'abc'", {"abc"}));
     print_result("Letters 'hello world'", 
-                 test_error_case("Letters 'hello world'", {"hello", "world"}).status);
+                 test_error_case("Letters 'hello world'", {"hello", "world"}));
     print_result("Mixed '1a'", 
-                 test_error_case("Mixed '1a'", {"1a"}).status);
+                 test_error_case("Mixed '1a'", {"1a"}));
     print_result("Mixed 'a1'", 
-                 test_error_case("Mixed 'a1'", {"a1"}).status);
+                 test_error_case("Mixed 'a1'", {"a1"}));
     print_result("Mixed '1a2'", 
-                 test_error_case("Mixed '1a2'", {"1a2"}).status);
+                 test_error_case("Mixed '1a2'", {"1a2"}));
     print_result("Mixed '111a11'", 
-                 test_error_case("Mixed '111a11'", {"111a11"}).status);
+                 test_error_case("Mixed '111a11'", {"111a11"}));
     print_result("Mixed '111a111 -4 3'", 
-                 test_error_case("Mixed '111a111'", {"111a111", "-4", "3"}).status);
+                 test_error_case("Mixed '111a111'", {"111a111", "-4", "3"}));
     print_result("Letter in middle '1 a 2'", 
-                 test_error_case("Letter in middle", {"1", "a", "2"}).status);
+                 test_error_case("Letter in middle", {"1", "a", "2"}));
     print_result("Letter 'x' in long list", 
-                 test_error_case("Letter x in list", {"42", "41", "40", "45", "101", "x", "202", "-1", "224", "3"}).status);
+                 test_error_case("Letter x in list", {"42", "41", "40", "45", "101", "x", "202", "-1", "224", "3"}));
     print_result("Letter 'e' at end of list", 
-                 test_error_case("Letter e at end", {"42", "-2", "10", "11", "0", "90", "45", "500", "-200", "e"}).status);
+                 test_error_case("Letter e at end", {"42", "-2", "10", "11", "0", "90", "45", "500", "-200", "e"}));
     print_result("Single letter in list '42 a 41'", 
-                 test_error_case("Single letter in list", {"42", "a", "41"}).status);
+                 test_error_case("Single letter in list", {"42", "a", "41"}));
     print_result("Special char '@'", 
-                 test_error_case("Special char '@'", {"@"}).status);
+                 test_error_case("Special char '@'", {"@"}));
     print_result("Special char '#'", 
-                 test_error_case("Special char '#'", {"#"}).status);
+                 test_error_case("Special char '#'", {"#"}));
     print_result("Decimal '1.5'", 
-                 test_error_case("Decimal '1.5'", {"1.5"}).status);
+                 test_error_case("Decimal '1.5'", {"1.5"}));
     print_result("Comma separated '1,2,3'", 
-                 test_error_case("Comma separated", {"1,2,3"}).status);
+                 test_error_case("Comma separated", {"1,2,3"}));
     
     print_subheader("Sign Issues");
     print_result("Single plus '+'", 
-                 test_error_case("Single plus '+'", {"+"}).status);
+                 test_error_case("Single plus '+'", {"+"}));
     print_result("Single minus '-'", 
-                 test_error_case("Single minus '-'", {"-"}).status);
+                 test_error_case("Single minus '-'", {"-"}));
     print_result("Double plus '++5'", 
-                 test_error_case("Double plus '++5'", {"++5"}).status);
+                 test_error_case("Double plus '++5'", {"++5"}));
     print_result("Double minus '--5'", 
-                 test_error_case("Double minus '--5'", {"--5"}).status);
+                 test_error_case("Double minus '--5'", {"--5"}));
     print_result("Double minus '--123 1 321'", 
-                 test_error_case("Double minus in list", {"--123", "1", "321"}).status);
+                 test_error_case("Double minus in list", {"--123", "1", "321"}));
     print_result("Double plus '++123 1 321'", 
-                 test_error_case("Double plus in list", {"++123", "1", "321"}).status);
+                 test_error_case("Double plus in list", {"++123", "1", "321"}));
     print_result("Plus minus '+-5'", 
-                 test_error_case("Plus minus '+-5'", {"+-5"}).status);
+                 test_error_case("Plus minus '+-5'", {"+-5"}));
     print_result("Minus plus '-+5'", 
-                 test_error_case("Minus plus '-+5'", {"-+5"}).status);
+                 test_error_case("Minus plus '-+5'", {"-+5"}));
     print_result("Trailing plus '5+'", 
-                 test_error_case("Trailing plus '5+'", {"5+"}).status);
+                 test_error_case("Trailing plus '5+'", {"5+"}));
     print_result("Trailing minus '5-'", 
-                 test_error_case("Trailing minus '5-'", {"5-"}).status);
+                 test_error_case("Trailing minus '5-'", {"5-"}));
     print_result("Sign in middle '5-3'", 
-                 test_error_case("Sign in middle '5-3'", {"5-3"}).status);
+                 test_error_case("Sign in middle '5-3'", {"5-3"}));
     print_result("Sign in middle '111-1 2 -3'", 
-                 test_error_case("Sign in middle 111-1", {"111-1", "2", "-3"}).status);
+                 test_error_case("Sign in middle 111-1", {"111-1", "2", "-3"}));
     print_result("Sign in middle '3333-3333 1 4'", 
-                 test_error_case("Sign in middle 3333-3333", {"3333-3333", "1", "4"}).status);
+                 test_error_case("Sign in middle 3333-3333", {"3333-3333", "1", "4"}));
     print_result("Sign in middle '4222-4222'", 
-                 test_error_case("Sign in middle 4222-4222", {"4222-4222"}).status);
+                 test_error_case("Sign in middle 4222-4222", {"4222-4222"}));
     print_result("Plus in middle '3+3'", 
-                 test_error_case("Plus in middle 3+3", {"3+3"}).status);
+                 test_error_case("Plus in middle 3+3", {"3+3"}));
     print_result("Plus in middle '111+111 -4 3'", 
-                 test_error_case("Plus in middle 111+111", {"111+111", "-4", "3"}).status);
+                 test_error_case("Plus in middle 111+111", {"111+111", "-4", "3"}));
     print_result("Plus in number '2147483647+1'", 
-                 test_error_case("Plus in number 2147483647+1", {"2147483647+1"}).status);
+                 test_error_case("Plus in number 2147483647+1", {"2147483647+1"}));
     print_result("Space after sign '- 5'", 
-                 test_error_case("Space after sign", {"- 5"}).status);
+                 test_error_case("Space after sign", {"- 5"}));
     
     print_subheader("Integer Overflow");
     print_result("INT_MAX (2147483647)", 
-                 test_sort_case("INT_MAX", {2147483647}).status);
+                 test_sort_case("INT_MAX", {2147483647}));
     print_result("INT_MIN (-2147483648)", 
-                 test_sort_case("INT_MIN", {-2147483648}).status);
+                 test_sort_case("INT_MIN", {-2147483648}));
     print_result("INT_MAX + 1", 
-                 test_error_case("INT_MAX + 1", {"2147483648"}).status);
+                 test_error_case("INT_MAX + 1", {"2147483648"}));
     print_result("INT_MAX + 2 (2147483649)", 
-                 test_error_case("INT_MAX + 2", {"2147483649"}).status);
+                 test_error_case("INT_MAX + 2", {"2147483649"}));
     print_result("INT_MIN - 1", 
-                 test_error_case("INT_MIN - 1", {"-2147483649"}).status);
+                 test_error_case("INT_MIN - 1", {"-2147483649"}));
     print_result("INT_MIN - 2 (-2147483650)", 
-                 test_error_case("INT_MIN - 2", {"-2147483650"}).status);
+                 test_error_case("INT_MIN - 2", {"-2147483650"}));
     print_result("Huge number (26 digits)", 
-                 test_error_case("Huge 26 digit", {"99999999999999999999999999"}).status);
+                 test_error_case("Huge 26 digit", {"99999999999999999999999999"}));
     print_result("Huge negative (26 digits)", 
-                 test_error_case("Huge negative 26 digit", {"-99999999999999999999999999"}).status);
+                 test_error_case("Huge negative 26 digit", {"-99999999999999999999999999"}));
     print_result("Huge number (20 digits)", 
-                 test_error_case("Huge 20 digit", {"99999999999999999999"}).status);
+                 test_error_case("Huge 20 digit", {"99999999999999999999"}));
     print_result("Huge negative (20 digits)", 
-                 test_error_case("Huge negative 20 digit", {"-99999999999999999999"}).status);
+                 test_error_case("Huge negative 20 digit", {"-99999999999999999999"}));
     print_result("LLONG_MAX", 
-                 test_error_case("LLONG_MAX", {"9223372036854775807"}).status);
+                 test_error_case("LLONG_MAX", {"9223372036854775807"}));
     print_result("Near overflow positive", 
-                 test_error_case("Near overflow +", {"2147483650"}).status);
+                 test_error_case("Near overflow +", {"2147483650"}));
     print_result("Near overflow negative", 
-                 test_error_case("Near overflow -", {"-2147483650"}).status);
+                 test_error_case("Near overflow -", {"-2147483650"}));
     // Massive overflow that might cause leaks if not handled properly
     print_result("Massive overflow (50+ digits)", 
-                 test_error_case("Massive overflow", {"1", "2", "555555555555555555555555555555555555555555555555"}).status);
+                 test_error_case("Massive overflow", {"1", "2", "555555555555555555555555555555555555555555555555"}));
     // User's specific test - valid numbers followed by overflow
     print_result("Valid then overflow '1 2 3 99999999999999999999'", 
-                 test_error_case("Valid then overflow", {"1", "2", "3", "99999999999999999999"}).status);
+                 test_error_case("Valid then overflow", {"1", "2", "3", "99999999999999999999"}));
     print_result("Overflow at end of long list", 
-                 test_error_case("Overflow at end", {"42", "41", "40", "99999999999999999999999999"}).status);
+                 test_error_case("Overflow at end", {"42", "41", "40", "99999999999999999999999999"}));
     print_result("Negative overflow in list", 
-                 test_error_case("Negative overflow in list", {"-1", "-2", "-99999999999999999999"}).status);
+                 test_error_case("Negative overflow in list", {"-1", "-2", "-99999999999999999999"}));
     
     print_subheader("Leading Zeros (Duplicate Detection)");
     print_result("Leading zero '01' (single)",
-                 test_sort_case("Leading zero '01'", {1}).status);  // Single - should work
+                 test_sort_case("Leading zero '01'", {1}));  // Single - should work
     print_result("Many leading zeros '00001'", 
-                 test_sort_case("Leading zeros '00001'", {1}).status);
+                 test_sort_case("Leading zeros '00001'", {1}));
     print_result("Just zeros '000'", 
-                 test_sort_case("Just zeros '000'", {0}).status);
+                 test_sort_case("Just zeros '000'", {0}));
     // Duplicates hidden by leading zeros (should ERROR)
     print_result("Duplicate '1 01' (hidden)", 
-                 test_error_case("Duplicate hidden 1 01", {"1", "01"}).status);
+                 test_error_case("Duplicate hidden 1 01", {"1", "01"}));
     print_result("Duplicate '8 008 12' (leading zeros)", 
-                 test_error_case("Duplicate 8 008", {"8", "008", "12"}).status);
+                 test_error_case("Duplicate 8 008", {"8", "008", "12"}));
     print_result("Duplicate '-01 -001'", 
-                 test_error_case("Duplicate -01 -001", {"-01", "-001"}).status);
+                 test_error_case("Duplicate -01 -001", {"-01", "-001"}));
     print_result("Duplicate '00000001 1 9 3'", 
-                 test_error_case("Duplicate 00000001 1", {"00000001", "1", "9", "3"}).status);
+                 test_error_case("Duplicate 00000001 1", {"00000001", "1", "9", "3"}));
     print_result("Duplicate '111111 -4 3 03'", 
-                 test_error_case("Duplicate with 03", {"111111", "-4", "3", "03"}).status);
+                 test_error_case("Duplicate with 03", {"111111", "-4", "3", "03"}));
     print_result("Duplicate '00000003 003 9 1'", 
-                 test_error_case("Duplicate 00000003 003", {"00000003", "003", "9", "1"}).status);
+                 test_error_case("Duplicate 00000003 003", {"00000003", "003", "9", "1"}));
     print_result("Duplicate '0000000000000000000000009 x2'", 
-                 test_error_case("Duplicate many zeros 9", {"0000000000000000000000009", "000000000000000000000009"}).status);
+                 test_error_case("Duplicate many zeros 9", {"0000000000000000000000009", "000000000000000000000009"}));
     print_result("Duplicate '-000 -0000'", 
-                 test_error_case("Duplicate negative zeros", {"-000", "-0000"}).status);
+                 test_error_case("Duplicate negative zeros", {"-000", "-0000"}));
     print_result("Duplicate '-00042 -000042'", 
-                 test_error_case("Duplicate -00042 -000042", {"-00042", "-000042"}).status);
+                 test_error_case("Duplicate -00042 -000042", {"-00042", "-000042"}));
     
     print_subheader("Duplicates");
     print_result("Simple duplicate '1 1'", 
-                 test_error_case("Simple duplicate", {"1", "1"}).status);
+                 test_error_case("Simple duplicate", {"1", "1"}));
     print_result("Duplicate at end '1 2 3 1'", 
-                 test_error_case("Duplicate at end", {"1", "2", "3", "1"}).status);
+                 test_error_case("Duplicate at end", {"1", "2", "3", "1"}));
     print_result("Duplicate zeros '0 0'", 
-                 test_error_case("Duplicate zeros", {"0", "0"}).status);
+                 test_error_case("Duplicate zeros", {"0", "0"}));
     print_result("Duplicate negatives '-1 -1'", 
-                 test_error_case("Duplicate negatives", {"-1", "-1"}).status);
+                 test_error_case("Duplicate negatives", {"-1", "-1"}));
     print_result("Duplicate negatives '-3 -2 -2'", 
-                 test_error_case("Duplicate -3 -2 -2", {"-3", "-2", "-2"}).status);
+                 test_error_case("Duplicate -3 -2 -2", {"-3", "-2", "-2"}));
     print_result("Duplicate INT_MAX", 
-                 test_error_case("Duplicate INT_MAX", {"2147483647", "2147483647"}).status);
+                 test_error_case("Duplicate INT_MAX", {"2147483647", "2147483647"}));
     print_result("Duplicate with long list", 
-                 test_error_case("Duplicate long list", {"10", "-1", "-2", "-3", "-4", "-5", "-6", "90", "99", "10"}).status);
+                 test_error_case("Duplicate long list", {"10", "-1", "-2", "-3", "-4", "-5", "-6", "90", "99", "10"}));
     print_result("Duplicate '42 42'", 
-                 test_error_case("Duplicate 42 42", {"42", "42"}).status);
+                 test_error_case("Duplicate 42 42", {"42", "42"}));
     print_result("Duplicate negative '42 -42 -42'", 
-                 test_error_case("Duplicate 42 -42 -42", {"42", "-42", "-42"}).status);
+                 test_error_case("Duplicate 42 -42 -42", {"42", "-42", "-42"}));
     print_result("Duplicate -0 and 0", 
-                 test_error_case("Duplicate -0 and 0", {"-0", "0"}).status);
+                 test_error_case("Duplicate -0 and 0", {"-0", "0"}));
     print_result("Duplicate +0 and 0", 
-                 test_error_case("Duplicate +0 and 0", {"+0", "0"}).status);
+                 test_error_case("Duplicate +0 and 0", {"+0", "0"}));
     print_result("Duplicate 0 -0 1 -1 (zero dup)", 
-                 test_error_case("Duplicate 0 -0 1 -1", {"0", "-0", "1", "-1"}).status);
+                 test_error_case("Duplicate 0 -0 1 -1", {"0", "-0", "1", "-1"}));
     print_result("Duplicate 0 +0 1 -1 (zero dup)", 
-                 test_error_case("Duplicate 0 +0 1 -1", {"0", "+0", "1", "-1"}).status);
+                 test_error_case("Duplicate 0 +0 1 -1", {"0", "+0", "1", "-1"}));
     print_result("Duplicate at start '0 1 2 3 4 5 0'", 
-                 test_error_case("Duplicate 0 at start/end", {"0", "1", "2", "3", "4", "5", "0"}).status);
+                 test_error_case("Duplicate 0 at start/end", {"0", "1", "2", "3", "4", "5", "0"}));
     print_result("Duplicate '3 +3' (plus sign)", 
-                 test_error_case("Duplicate 3 +3", {"3", "+3"}).status);
+                 test_error_case("Duplicate 3 +3", {"3", "+3"}));
     print_result("Duplicate '1 +1 -1' (plus sign)", 
-                 test_error_case("Duplicate 1 +1 -1", {"1", "+1", "-1"}).status);
+                 test_error_case("Duplicate 1 +1 -1", {"1", "+1", "-1"}));
     
     print_subheader("Format Edge Cases");
     print_result("Quoted single arg '1 2 3'", 
-                 test_sort_case("Quoted single arg", {1, 2, 3}).status);
+                 test_sort_case("Quoted single arg", {1, 2, 3}));
     print_result("Extra spaces '  1   2  '", 
-                 test_sort_case("Extra spaces", {1, 2}).status);
+                 test_sort_case("Extra spaces", {1, 2}));
     print_result("Mixed quoted args", 
-                 test_sort_case("Mixed quoted args", {1, 2, 3, 4, 5}).status);
+                 test_sort_case("Mixed quoted args", {1, 2, 3, 4, 5}));
     print_result("Positive with plus '+5'", 
-                 test_sort_case("Positive with plus", {5}).status);
+                 test_sort_case("Positive with plus", {5}));
     print_result("Multiple args with plus", 
-                 test_sort_case("Multiple with plus", {1, 2, 3}).status);
+                 test_sort_case("Multiple with plus", {1, 2, 3}));
 }
 
 void run_basic_sorting_tests() {
     print_header("BASIC SORTING TESTS");
     
     print_subheader("Single Element");
-    print_result("Single 0", test_sort_case("Single 0", {0}).status);
-    print_result("Single 1", test_sort_case("Single 1", {1}).status);
-    print_result("Single -1", test_sort_case("Single -1", {-1}).status);
-    print_result("Single INT_MAX", test_sort_case("Single INT_MAX", {2147483647}).status);
-    print_result("Single INT_MIN", test_sort_case("Single INT_MIN", {-2147483648}).status);
+    print_result("Single 0", test_sort_case("Single 0", {0}));
+    print_result("Single 1", test_sort_case("Single 1", {1}));
+    print_result("Single -1", test_sort_case("Single -1", {-1}));
+    print_result("Single INT_MAX", test_sort_case("Single INT_MAX", {2147483647}));
+    print_result("Single INT_MIN", test_sort_case("Single INT_MIN", {-2147483648}));
     
     print_subheader("Two Elements");
-    print_result("Sorted 1 2", test_sort_case("Sorted 1 2", {1, 2}).status);
-    print_result("Reversed 2 1", test_sort_case("Reversed 2 1", {2, 1}).status);
-    print_result("Negative pair", test_sort_case("Negative pair", {-2, -1}).status);
-    print_result("Mixed signs -1 1", test_sort_case("Mixed signs", {-1, 1}).status);
-    print_result("With zero 0 1", test_sort_case("With zero", {0, 1}).status);
-    print_result("Large diff", test_sort_case("Large diff", {-2147483648, 2147483647}).status);
+    print_result("Sorted 1 2", test_sort_case("Sorted 1 2", {1, 2}));
+    print_result("Reversed 2 1", test_sort_case("Reversed 2 1", {2, 1}));
+    print_result("Negative pair", test_sort_case("Negative pair", {-2, -1}));
+    print_result("Mixed signs -1 1", test_sort_case("Mixed signs", {-1, 1}));
+    print_result("With zero 0 1", test_sort_case("With zero", {0, 1}));
+    print_result("Large diff", test_sort_case("Large diff", {-2147483648, 2147483647}));
     
     print_subheader("Three Elements (all permutations - should be ≤3 ops)");
-    print_result("Already sorted 1 2 3", test_sort_case("Sorted 1 2 3", {1, 2, 3}).status);
-    print_result("Reversed 3 2 1", test_sort_case("Reversed 3 2 1", {3, 2, 1}).status);
-    print_result("Rotation 2 3 1", test_sort_case("Rotation 2 3 1", {2, 3, 1}).status);
-    print_result("Rotation 3 1 2", test_sort_case("Rotation 3 1 2", {3, 1, 2}).status);
-    print_result("Swap needed 2 1 3", test_sort_case("Swap 2 1 3", {2, 1, 3}).status);
-    print_result("Swap needed 1 3 2", test_sort_case("Swap 1 3 2", {1, 3, 2}).status);
+    print_result("Already sorted 1 2 3", test_sort_case("Sorted 1 2 3", {1, 2, 3}));
+    print_result("Reversed 3 2 1", test_sort_case("Reversed 3 2 1", {3, 2, 1}));
+    print_result("Rotation 2 3 1", test_sort_case("Rotation 2 3 1", {2, 3, 1}));
+    print_result("Rotation 3 1 2", test_sort_case("Rotation 3 1 2", {3, 1, 2}));
+    print_result("Swap needed 2 1 3", test_sort_case("Swap 2 1 3", {2, 1, 3}));
+    print_result("Swap needed 1 3 2", test_sort_case("Swap 1 3 2", {1, 3, 2}));
     
     print_subheader("Four Elements (all 24 permutations - should be ≤12 ops)");
     // All 24 permutations of {1,2,3,4}
@@ -1054,35 +3445,41 @@ void run_basic_sorting_tests() {
         {4,1,2,3}, {4,1,3,2}, {4,2,1,3}, {4,2,3,1}, {4,3,1,2}, {4,3,2,1}
     };
     {
-        int passed = 0, failed = 0, total = four_perms.size();
-        vector<int> ops_list;
-        int max_ops = 0, min_ops = INT_MAX;
+        int total = four_perms.size();
+        vector<TestHandle> runs;
         
         for (size_t i = 0; i < four_perms.size(); ++i) {
-            print_progress(i + 1, total, "  Testing 4-elem");
-            const auto& p = four_perms[i];
-            auto r = test_sort_case("4elem", p);
-            if (r.passed) {
-                passed++;
-                ops_list.push_back(r.instruction_count);
-                max_ops = max(max_ops, r.instruction_count);
-                min_ops = min(min_ops, r.instruction_count);
-            } else {
-                failed++;
-            }
+            pool.ordered([=] { print_progress(i + 1, total, "  Testing 4-elem"); });
+            runs.push_back(test_sort_case("4elem", four_perms[i]));
         }
-        clear_line();
         
-        string status = (failed == 0) ? PASS : FAIL;
-        int avg = ops_list.empty() ? 0 : accumulate(ops_list.begin(), ops_list.end(), 0) / ops_list.size();
-        cout << "  " << status << "  " << GRN << passed << RST << "/" << total << " passed";
-        if (!ops_list.empty()) {
-            cout << "  " << GRY << "Min: " << RST << min_ops;
-            cout << "  " << GRY << "Max: " << RST << max_ops;
-            cout << "  " << GRY << "Avg: " << RST << avg << " ops";
-        }
-        if (failed > 0) cout << "  " << RED << failed << " failed" << RST;
-        cout << "\n";
+        pool.ordered([=] {
+            int passed = 0, failed = 0;
+            vector<int> ops_list;
+            int max_ops = 0, min_ops = INT_MAX;
+            for (const auto& r : runs) {
+                if (r->passed) {
+                    passed++;
+                    ops_list.push_back(r->instruction_count);
+                    max_ops = max(max_ops, r->instruction_count);
+                    min_ops = min(min_ops, r->instruction_count);
+                } else {
+                    failed++;
+                }
+            }
+            clear_line();
+            
+            string status = (failed == 0) ? PASS : FAIL;
+            int avg = ops_list.empty() ? 0 : accumulate(ops_list.begin(), ops_list.end(), 0) / ops_list.size();
+            cout << "  " << status << "  " << GRN << passed << RST << "/" << total << " passed";
+            if (!ops_list.empty()) {
+                cout << "  " << GRY << "Min: " << RST << min_ops;
+                cout << "  " << GRY << "Max: " << RST << max_ops;
+                cout << "  " << GRY << "Avg: " << RST << avg << " ops";
+            }
+            if (failed > 0) cout << "  " << RED << failed << " failed" << RST;
+            cout << "\n";
+        });
     }
     
     print_subheader("Five Elements (ALL 120 permutations - should be ≤12 ops)");
@@ -1110,50 +3507,56 @@ void run_basic_sorting_tests() {
         {5,4,1,2,3}, {5,4,1,3,2}, {5,4,2,1,3}, {5,4,2,3,1}, {5,4,3,1,2}, {5,4,3,2,1}
     };
     {
-        int passed = 0, failed = 0, total = five_perms.size();
-        vector<int> ops_list;
-        int max_ops = 0, min_ops = INT_MAX;
+        int total = five_perms.size();
+        vector<TestHandle> runs;
         
         for (size_t i = 0; i < five_perms.size(); ++i) {
-            print_progress(i + 1, total, "  Testing 5-elem");
-            const auto& p = five_perms[i];
-            auto r = test_sort_case("5elem", p);
-            if (r.passed) {
-                passed++;
-                ops_list.push_back(r.instruction_count);
-                max_ops = max(max_ops, r.instruction_count);
-                min_ops = min(min_ops, r.instruction_count);
-            } else {
-                failed++;
-            }
+            pool.ordered([=] { print_progress(i + 1, total, "  Testing 5-elem"); });
+            runs.push_back(test_sort_case("5elem", five_perms[i]));
         }
-        clear_line();
         
-        string status = (failed == 0) ? PASS : FAIL;
-        int avg = ops_list.empty() ? 0 : accumulate(ops_list.begin(), ops_list.end(), 0) / ops_list.size();
-        cout << "  " << status << "  " << GRN << passed << RST << "/" << total << " passed";
-        if (!ops_list.empty()) {
-            cout << "  " << GRY << "Min: " << RST << min_ops;
-            cout << "  " << GRY << "Max: " << RST << max_ops;
-            cout << "  " << GRY << "Avg: " << RST << avg << " ops";
-        }
-        if (failed > 0) cout << "  " << RED << failed << " failed" << RST;
-        cout << "\n";
+        pool.ordered([=] {
+            int passed = 0, failed = 0;
+            vector<int> ops_list;
+            int max_ops = 0, min_ops = INT_MAX;
+            for (const auto& r : runs) {
+                if (r->passed) {
+                    passed++;
+                    ops_list.push_back(r->instruction_count);
+                    max_ops = max(max_ops, r->instruction_count);
+                    min_ops = min(min_ops, r->instruction_count);
+                } else {
+                    failed++;
+                }
+            }
+            clear_line();
+            
+            string status = (failed == 0) ? PASS : FAIL;
+            int avg = ops_list.empty() ? 0 : accumulate(ops_list.begin(), ops_list.end(), 0) / ops_list.size();
+            cout << "  " << status << "  " << GRN << passed << RST << "/" << total << " passed";
+            if (!ops_list.empty()) {
+                cout << "  " << GRY << "Min: " << RST << min_ops;
+                cout << "  " << GRY << "Max: " << RST << max_ops;
+                cout << "  " << GRY << "Avg: " << RST << avg << " ops";
+            }
+            if (failed > 0) cout << "  " << RED << failed << " failed" << RST;
+            cout << "\n";
+        });
     }
     
     print_subheader("Edge Value Combinations");
     print_result("INT boundaries", 
-                 test_sort_case("INT boundaries", {-2147483648, 0, 2147483647}).status);
+                 test_sort_case("INT boundaries", {-2147483648, 0, 2147483647}));
     print_result("All negative", 
-                 test_sort_case("All negative", {-5, -3, -1, -4, -2}).status);
+                 test_sort_case("All negative", {-5, -3, -1, -4, -2}));
     print_result("All same sign", 
-                 test_sort_case("All same sign", {100, 200, 300, 400, 500}).status);
+                 test_sort_case("All same sign", {100, 200, 300, 400, 500}));
     print_result("Zero in middle", 
-                 test_sort_case("Zero in middle", {-2, -1, 0, 1, 2}).status);
+                 test_sort_case("Zero in middle", {-2, -1, 0, 1, 2}));
     print_result("INT_MAX sorted 3", 
-                 test_sort_case("INT_MAX sorted 3", {2147483645, 2147483646, 2147483647}).status);
+                 test_sort_case("INT_MAX sorted 3", {2147483645, 2147483646, 2147483647}));
     print_result("INT_MIN sorted 3", 
-                 test_sort_case("INT_MIN sorted 3", {-2147483648, -2147483647, -2147483646}).status);
+                 test_sort_case("INT_MIN sorted 3", {-2147483648, -2147483647, -2147483646}));
 }
 
 void run_special_cases() {
@@ -1181,35 +3584,39 @@ void run_special_cases() {
         vector<string> args;
         for (int n : tc.second) args.push_back(to_string(n));
         
-        auto r = run_push_swap(args, false);
-        int ops = count_instructions(r.stdout_data);
-        
-        string status;
-        if (ops == 0 && r.exit_code == 0 && r.signal_num == 0) {
-            status = PASS;
-            stats.passed++;
-        } else if (r.timed_out) {
-            status = TOUT;
-            stats.timeouts++;
-        } else if (r.signal_num != 0) {
-            status = SEGV;
-            stats.crashes++;
-        } else {
-            status = FAIL;
-            stats.failed++;
-            log_error(tc.first, "Already sorted test", "Expected 0 ops, got " + to_string(ops), args);
-        }
-        stats.total++;
-        
-        string detail = (ops == 0) ? GRN "0 ops" RST : RED + to_string(ops) + " ops (expected 0)" RST;
-        print_result(tc.first, status, detail);
+        auto r = make_shared<ExecResult>();
+        pool.submit([=] { *r = run_push_swap(args, false); }, [=] {
+            int ops = count_instructions(r->stdout_data);
+            
+            string status;
+            if (ops == 0 && r->exit_code == 0 && r->signal_num == 0) {
+                status = PASS;
+                stats.passed++;
+            } else if (r->timed_out) {
+                status = TOUT;
+                stats.timeouts++;
+            } else if (r->signal_num != 0) {
+                status = SEGV;
+                stats.crashes++;
+            } else {
+                status = FAIL;
+                stats.failed++;
+                log_error(tc.first, "Already sorted test", "Expected 0 ops, got " + to_string(ops), args);
+            }
+            stats.total++;
+            report_test(tc.first, "Already sorted test", ops == 0 && r->exit_code == 0 && r->signal_num == 0,
+                        ops == 0 ? "" : "Expected 0 ops, got " + to_string(ops), *r, ops);
+            
+            string detail = (ops == 0) ? GRN "0 ops" RST : RED + to_string(ops) + " ops (expected 0)" RST;
+            print_result(tc.first, status, detail);
+        });
     }
     
     print_subheader("Reverse Sorted");
     for (int n : {2, 3, 5, 10, 20}) {
         auto v = generate_reversed(n);
         auto r = test_sort_case("Reversed " + to_string(n), v);
-        print_result("Reversed " + to_string(n) + " elements", r.status, to_string(r.instruction_count) + " ops");
+        print_result("Reversed " + to_string(n) + " elements", r, true);
     }
     
     print_subheader("Rotated Arrays");
@@ -1217,16 +3624,16 @@ void run_special_cases() {
         for (int rot : {1, n/2, n-1}) {
             auto v = generate_rotated(n, rot);
             auto r = test_sort_case("Rotated " + to_string(n) + " by " + to_string(rot), v);
-            print_result("Rotated " + to_string(n) + " by " + to_string(rot), r.status, 
-                        to_string(r.instruction_count) + " ops");
+            print_result("Rotated " + to_string(n) + " by " + to_string(rot), r, true);
         }
     }
     
     print_subheader("Nearly Sorted");
     for (int n : {10, 20, 50}) {
-        auto v = generate_nearly_sorted(n, 2);
-        auto r = test_sort_case("Nearly sorted " + to_string(n), v);
-        print_result("Nearly sorted " + to_string(n), r.status, to_string(r.instruction_count) + " ops");
+        string name = "Nearly sorted " + to_string(n);
+        uint64_t seed = test_seed(name);
+        auto r = test_sort_case(name, generate_nearly_sorted(n, 2, seed), true, seed);
+        print_result("Nearly sorted " + to_string(n), r, true);
     }
     
     print_subheader("Big Number Ranges (500 numbers)");
@@ -1251,141 +3658,313 @@ void run_special_cases() {
     };
     
     for (const auto& tc : big_ranges) {
-        auto v = generate_range(tc.second.first, tc.second.second);
-        random_device rd;
-        mt19937 gen(rd());
-        shuffle(v.begin(), v.end(), gen);
-        auto r = test_sort_case("Range " + tc.first, v);
-        print_result("Range " + tc.first + " shuffled", r.status, to_string(r.instruction_count) + " ops");
+        uint64_t seed = test_seed("Range " + tc.first);
+        auto v = generate_shuffled_range(tc.second.first, tc.second.second, seed);
+        auto r = test_sort_case("Range " + tc.first, v, true, seed);
+        print_result("Range " + tc.first + " shuffled", r, true);
     }
     
     print_subheader("INT_MIN Area Tests (500 numbers)");
     // Test with INT_MIN boundary values
     {
-        auto v = generate_range(-2147483648, -2147483149);  // 500 numbers near INT_MIN
-        random_device rd;
-        mt19937 gen(rd());
-        shuffle(v.begin(), v.end(), gen);
-        auto r = test_sort_case("INT_MIN area 500", v);
-        print_result("INT_MIN to INT_MIN+499 shuffled", r.status, to_string(r.instruction_count) + " ops");
+        uint64_t seed = test_seed("INT_MIN area 500");
+        auto v = generate_shuffled_range(-2147483648, -2147483149, seed);  // 500 numbers near INT_MIN
+        auto r = test_sort_case("INT_MIN area 500", v, true, seed);
+        print_result("INT_MIN to INT_MIN+499 shuffled", r, true);
     }
     {
-        auto v = generate_range(-2147483648, -2147483149);  // Again to verify consistency
-        random_device rd;
-        mt19937 gen(rd());
-        shuffle(v.begin(), v.end(), gen);
-        auto r = test_sort_case("INT_MIN area 500 #2", v);
-        print_result("INT_MIN area shuffled #2", r.status, to_string(r.instruction_count) + " ops");
+        uint64_t seed = test_seed("INT_MIN area 500 #2");
+        auto v = generate_shuffled_range(-2147483648, -2147483149, seed);  // Again to verify consistency
+        auto r = test_sort_case("INT_MIN area 500 #2", v, true, seed);
+        print_result("INT_MIN area shuffled #2", r, true);
     }
 }
 
 void run_performance_tests() {
     print_header("PERFORMANCE BENCHMARKS");
     
-    auto run_benchmark = [](int n, int iterations, const vector<Threshold>& thresholds) {
-        vector<int> results;
-        int failures = 0;
-        int leaks = 0;
+    auto run_benchmark = [](int n, int iterations, const vector<Threshold>& thresholds, bool tail = false) {
+        struct Bench {
+            vector<int> results;
+            int failures = 0;
+            int leak_runs = 0;     // leak-checked runs that completed
+            int leaks = 0;
+            int64_t leaked_bytes = 0;
+            long long peak_heap = 0;
+            UsageTotals usage;     // of the runs that sorted
+            vector<int> by_input;  // ops per input index, -1 = failed
+            double wall_ms = 0;
+        };
+        auto bench = make_shared<Bench>();
         
-        cout << "\n" << BLD << "Size " << n << " (" << iterations << " iterations)" << RST << "\n";
+        // The shim costs next to nothing: every run is leak-checked in
+        // place. Valgrind re-runs a sample instead, see below.
+        bool shim_leaks = cfg.use_valgrind && !cfg.leak_shim.empty();
+        auto tally_leaks = [=](const ExecResult& r, const vector<string>& args, int i, uint64_t seed) {
+            bench->leak_runs++;
+            bench->peak_heap = max(bench->peak_heap, r.peak_heap);
+            if (!r.has_leaks) return;
+            bench->leaks++;
+            bench->leaked_bytes += r.leaked_bytes;
+            log_trace("Perf_" + to_string(n) + "_leak", args, to_string(r.leaked_bytes) + " bytes leaked");
+            log_error("Perf " + to_string(n) + " #" + to_string(i + 1), "Memory Leak",
+                      to_string(r.leaked_bytes) + " bytes leaked" + leak_report(r) + usage_report(r), args, seed);
+        };
         
-        for (int i = 0; i < iterations; ++i) {
-            print_progress(i + 1, iterations, "  Testing");
+        // Adaptive runs go in batches until the confidence interval of the
+        // chosen statistic sits in one grade band, or the cap
+        bool adaptive = cfg.adaptive_q != 0 && !tail;
+        if (adaptive) iterations = cfg.max_iterations;
+        
+        // Failed runs are the high tail (--early-kill stops exactly those):
+        // they score past every limit in a quantile, and a mean over the
+        // runs that survived can't settle while there are any
+        auto adaptive_sample = [=] {
+            vector<int> sample = bench->results;
+            if (cfg.adaptive_q > 0) sample.insert(sample.end(), bench->failures, INT_MAX);
+            sort(sample.begin(), sample.end());
+            return sample;
+        };
+        auto settled = [=](const vector<int>& sample) {
+            if (cfg.adaptive_q < 0 && bench->failures > 0) return false;
+            return grade_settled(confidence_interval(sample, cfg.adaptive_q), thresholds);
+        };
+        
+        pool.ordered([=] {
+            cout << "\n" << BLD << "Size " << n << " (";
+            if (adaptive) cout << "adaptive, up to " << iterations << " iterations)";
+            else cout << iterations << " iterations)";
+            cout << RST << "\n";
+        });
+        
+        // With --early-kill a run is stopped once it can only score 0: past
+        // the last finite limit of the table
+        int budget = 0;
+        if (cfg.early_kill && thresholds.back().limit != INT_MAX) budget = thresholds.back().limit;
+        
+        auto submit_run = [=](int i) {
+            uint64_t seed = test_seed("Perf " + to_string(n), i);
+            auto nums = generate_unique_random(n, -1000000, 1000000, seed);
+            vector<string> args;
+            for (int num : nums) args.push_back(to_string(num));
             
-            auto nums = generate_unique_random(n, -1000000, 1000000);
+            // Validation runs on the worker, the commit only tallies
+            struct Run { ExecResult r; int ops = 0; string failure; string details; };
+            auto run = make_shared<Run>();
+            
+            pool.submit([=] {
+                StreamVerifier verifier(nums, cfg.early_kill, budget);
+                verifier.keep_ops();
+                OutputSink sink = [&verifier](const char* data, size_t len) { return verifier.feed(data, len); };
+                ExecResult& r = run->r;
+                r = run_push_swap(args, shim_leaks, &sink, true);
+                verifier.finish();
+                run->ops = verifier.count();
+                
+                if (r.timed_out || r.signal_num != 0) {
+                    run->failure = "crash";
+                } else if (r.output_truncated) {
+                    run->failure = "overflow";
+                    run->details = "Output exceeded " + format_bytes(cfg.max_output);
+                } else if (!verifier.is_valid()) {
+                    run->failure = "invalid";
+                    run->details = verifier.error();
+                } else if (verifier.is_over_budget()) {
+                    run->failure = "budget";
+                    run->details = "Stopped past " + to_string(budget) + " ops";
+                } else if (!verifier.is_sorted()) {
+                    run->failure = "nosort";
+                }
+                if (!run->failure.empty()) r.stdout_data = verifier.output();
+            }, [=] {
+                print_progress(i + 1, iterations, "  Testing");
+                report_test("Perf " + to_string(n) + " #" + to_string(i + 1), "Performance", run->failure.empty(),
+                            run->failure + (run->details.empty() ? "" : ": " + run->details), run->r, run->ops, seed);
+                
+                if ((int)bench->by_input.size() <= i) bench->by_input.resize(i + 1, -1);
+                if (!run->failure.empty()) {
+                    bench->failures++;
+                    string name = "Perf " + to_string(n) + " #" + to_string(i + 1);
+                    int64_t offset;
+                    uint32_t size;
+                    log_trace("Perf_" + to_string(n) + "_" + run->failure, args, run->details);
+                    log_error(name, "Performance",
+                              run->failure + (run->details.empty() ? "" : ": " + run->details) + usage_report(run->r) +
+                              spill_output(name, run->r, offset, size), args, seed);
+                    run->r = ExecResult();
+                    return;
+                }
+                
+                bench->results.push_back(run->ops);
+                bench->by_input[i] = run->ops;
+                bench->wall_ms += run->r.exec_time_ms;
+                bench->usage.add(run->r);
+                if (shim_leaks) tally_leaks(run->r, args, i, seed);
+            });
+        };
+        
+        int runs = 0;
+        if (!adaptive) {
+            for (; runs < iterations; ++runs) submit_run(runs);
+        } else {
+            // A quantile's upper bound needs enough samples above it
+            size_t min_runs = 10;
+            while (cfg.adaptive_q > 0 && min_runs < (size_t)iterations &&
+                   min_runs * cfg.adaptive_q + 1.96 * sqrt(min_runs * cfg.adaptive_q * (1 - cfg.adaptive_q)) > min_runs - 1) {
+                min_runs++;
+            }
+            int batch = max(10, 2 * cfg.jobs);
+            while (runs < iterations) {
+                for (int end = min(iterations, runs + batch); runs < end; ++runs) submit_run(runs);
+                pool.drain();
+                vector<int> sample = adaptive_sample();
+                if (sample.size() >= min_runs && settled(sample)) break;
+            }
+        }
+        
+        // Op counts and timings come from the native runs above. Leak checks
+        // re-run a sample of the same inputs under valgrind, queued behind
+        // them so they fill the workers without holding up the numbers.
+        for (int i = 0; cfg.use_valgrind && !shim_leaks && i < runs; ++i) {
+            uint64_t seed = test_seed("Perf " + to_string(n), i);
+            if (!leak_sampled(i, seed)) continue;
+            auto nums = generate_unique_random(n, -1000000, 1000000, seed);
             vector<string> args;
             for (int num : nums) args.push_back(to_string(num));
             
-            ExecResult r = run_push_swap(args, cfg.use_valgrind);
+            auto r = make_shared<ExecResult>();
+            pool.submit([=] { *r = run_push_swap(args, true); }, [=] {
+                if (r->timed_out || r->signal_num != 0) return;
+                tally_leaks(*r, args, i, seed);
+            }, valgrind_job(true, n));
+        }
+        
+        pool.ordered([=] {
+            vector<int> results = bench->results;
+            int failures = bench->failures;
+            
+            clear_line();
             
-            if (r.timed_out || r.signal_num != 0) {
-                failures++;
-                log_trace("Perf_" + to_string(n) + "_crash", args);
-                continue;
+            PerfRun& history = stats.perf_runs[n];
+            history.ops = bench->by_input;
+            if (!results.empty()) history.wall_ms = bench->wall_ms / results.size();
+            if (bench->usage.runs > 0) history.cpu_ms = (bench->usage.user_ms + bench->usage.sys_ms) / bench->usage.runs;
+            
+            if (results.empty()) {
+                cout << "  " << RED << "All tests failed!" << RST << "\n";
+                return;
             }
             
-            if (!validate_all_instructions(r.stdout_data)) {
-                failures++;
-                log_trace("Perf_" + to_string(n) + "_invalid", args);
-                continue;
+            sort(results.begin(), results.end());
+            int min_v = results.front();
+            int max_v = results.back();
+            int avg = accumulate(results.begin(), results.end(), 0) / results.size();
+            int median = results[results.size() / 2];
+            
+            // Calculate percentiles
+            int p90 = results[(int)(results.size() * 0.9)];
+            int p95 = results[(int)(results.size() * 0.95)];
+            
+            cout << "  " << GRY << "Min: " << RST << min_v;
+            cout << "  " << GRY << "Max: " << RST << max_v;
+            cout << "  " << GRY << "Median: " << RST << median;
+            cout << "  " << GRY << "Avg: " << RST << BLD << avg << RST;
+            cout << "\n";
+            
+            cout << "  " << GRY << "P90: " << RST << p90;
+            cout << "  " << GRY << "P95: " << RST << p95;
+            cout << "\n";
+            
+            // Grading, on the quantile adaptive sampling settled if it's one
+            int graded = avg;
+            bool by_quantile = adaptive && cfg.adaptive_q > 0;
+            vector<int> sample = adaptive ? adaptive_sample() : results;
+            if (by_quantile) graded = sample[min(sample.size() - 1, (size_t)(sample.size() * cfg.adaptive_q))];
+            string grade = get_grade(graded, thresholds);
+            int score = get_score(graded, thresholds);
+            
+            cout << "  " << BLD << "Grade";
+            if (by_quantile) {
+                cout << " (" << stat_name(cfg.adaptive_q) << " " << (graded == INT_MAX ? "failed" : to_string(graded)) << ")";
             }
+            cout << ": " << RST;
+            if (score >= 5) cout << GRN << "★★★★★ " << grade << RST;
+            else if (score >= 4) cout << GRN << "★★★★☆ " << grade << RST;
+            else if (score >= 3) cout << YEL << "★★★☆☆ " << grade << RST;
+            else if (score >= 2) cout << YEL << "★★☆☆☆ " << grade << RST;
+            else cout << RED << "★☆☆☆☆ " << grade << RST;
             
-            if (!verify_sort(nums, r.stdout_data)) {
-                // Double check with checker
-                if (!cfg.checker.empty()) {
-                    ExecResult chk = run_checker(args, r.stdout_data);
-                    if (chk.stdout_data.find("OK") == string::npos) {
-                        failures++;
-                        log_trace("Perf_" + to_string(n) + "_ko", args, "Checker returned KO");
-                        continue;
-                    }
-                } else {
-                    failures++;
-                    log_trace("Perf_" + to_string(n) + "_nosort", args);
-                    continue;
+            // Threshold info
+            cout << "\n  " << GRY << "Thresholds: ";
+            for (size_t i = 0; i < thresholds.size(); ++i) {
+                cout << thresholds[i].score << "/5≤" << thresholds[i].limit;
+                if (i < thresholds.size() - 1) cout << ", ";
+            }
+            cout << RST << "\n";
+            
+            if (adaptive) {
+                auto ci = confidence_interval(sample, cfg.adaptive_q);
+                auto bound = [](double v) {
+                    ostringstream o;
+                    if (v >= INT_MAX) o << "failed";
+                    else o << fixed << setprecision(1) << v;
+                    return o.str();
+                };
+                cout << "  " << GRY << "Adaptive: " << RST << "95% CI " << stat_name(cfg.adaptive_q)
+                     << " [" << bound(ci.first) << ", " << bound(ci.second) << "] after " << runs << " runs "
+                     << (settled(sample) ? GRN "(settled)" : YEL "(cap reached)") << RST << "\n";
+            }
+            
+            // Tail risk: how often a single run goes past each limit, from
+            // the empirical distribution, and what that means for an
+            // evaluation of k random inputs that must all make it. Failed
+            // and early-killed runs are the tail too: they count as over
+            // every limit
+            if (tail) {
+                int k = cfg.eval_trials;
+                int total = results.size() + failures;
+                cout << "  " << BLD << "Tail risk" << RST << GRY << " (" << total << " runs, evaluation of "
+                     << k << " inputs)" << RST << "\n";
+                for (const auto& t : thresholds) {
+                    if (t.limit == INT_MAX) continue;
+                    int over = results.end() - upper_bound(results.begin(), results.end(), t.limit) + failures;
+                    auto ci = wilson_interval(over, total);
+                    double p = (double)over / total;
+                    ostringstream line;
+                    line << fixed << setprecision(2)
+                         << "P(>" << setw(5) << t.limit << ") " << setw(6) << p * 100 << "% ["
+                         << ci.first * 100 << ", " << ci.second * 100 << "]   all " << k << " within: "
+                         << setw(6) << pow(1 - p, k) * 100 << "% [" << pow(1 - ci.second, k) * 100 << ", "
+                         << pow(1 - ci.first, k) * 100 << "]";
+                    const char* color = p == 0 ? GRN : (pow(1 - p, k) >= 0.95 ? YEL : RED);
+                    cout << "    " << color << line.str() << RST << GRY << "  (" << t.grade << ")" << RST << "\n";
                 }
             }
             
-            if (r.has_leaks) leaks++;
+            if (bench->usage.runs > 0) {
+                cout << "  " << GRY << "Per run: " << RST << usage_line(bench->usage) << "\n";
+            }
             
-            int count = count_instructions(r.stdout_data);
-            results.push_back(count);
-        }
-        
-        clear_line();
-        
-        if (results.empty()) {
-            cout << "  " << RED << "All tests failed!" << RST << "\n";
-            return;
-        }
-        
-        sort(results.begin(), results.end());
-        int min_v = results.front();
-        int max_v = results.back();
-        int avg = accumulate(results.begin(), results.end(), 0) / results.size();
-        int median = results[results.size() / 2];
-        
-        // Calculate percentiles
-        int p90 = results[(int)(results.size() * 0.9)];
-        int p95 = results[(int)(results.size() * 0.95)];
-        
-        cout << "  " << GRY << "Min: " << RST << min_v;
-        cout << "  " << GRY << "Max: " << RST << max_v;
-        cout << "  " << GRY << "Median: " << RST << median;
-        cout << "  " << GRY << "Avg: " << RST << BLD << avg << RST;
-        cout << "\n";
-        
-        cout << "  " << GRY << "P90: " << RST << p90;
-        cout << "  " << GRY << "P95: " << RST << p95;
-        cout << "\n";
-        
-        // Grading
-        string grade = get_grade(avg, thresholds);
-        int score = get_score(avg, thresholds);
-        
-        cout << "  " << BLD << "Grade: " << RST;
-        if (score >= 5) cout << GRN << "★★★★★ " << grade << RST;
-        else if (score >= 4) cout << GRN << "★★★★☆ " << grade << RST;
-        else if (score >= 3) cout << YEL << "★★★☆☆ " << grade << RST;
-        else if (score >= 2) cout << YEL << "★★☆☆☆ " << grade << RST;
-        else cout << RED << "★☆☆☆☆ " << grade << RST;
-        
-        // Threshold info
-        cout << "\n  " << GRY << "Thresholds: ";
-        for (size_t i = 0; i < thresholds.size(); ++i) {
-            cout << thresholds[i].score << "/5≤" << thresholds[i].limit;
-            if (i < thresholds.size() - 1) cout << ", ";
-        }
-        cout << RST << "\n";
-        
-        if (failures > 0) {
-            cout << "  " << RED << "Failures: " << failures << RST << "\n";
-        }
-        if (leaks > 0) {
-            cout << "  " << YEL << "Memory leaks detected in " << leaks << " tests" << RST << "\n";
-        }
-        
-        stats.perf_results[to_string(n)] = results;
+            if (failures > 0) {
+                cout << "  " << RED << "Failures: " << failures << RST << "\n";
+            }
+            if (bench->leak_runs > 0) {
+                if (shim_leaks) {
+                    cout << "  " << GRY << "Leak check: " << RST << bench->leak_runs << " runs, peak heap "
+                         << format_bytes(bench->peak_heap) << ", ";
+                } else {
+                    cout << "  " << GRY << "Leak sample: " << RST << bench->leak_runs << " runs under valgrind, ";
+                }
+                if (bench->leaks > 0) {
+                    cout << YEL << bench->leaks << " leaked (" << format_bytes(bench->leaked_bytes) << " total)" << RST << "\n";
+                } else {
+                    cout << GRN << "no leaks" << RST << "\n";
+                }
+            }
+            
+            stats.perf_results[to_string(n)] = results;
+            stats.perf_usage[to_string(n)] = bench->usage;
+        });
     };
     
     int quick_iter = cfg.quick_mode ? 10 : 50;
@@ -1403,18 +3982,35 @@ void run_performance_tests() {
     
     // Required benchmarks
     print_subheader("Required Benchmarks (100 & 500)");
-    run_benchmark(100, stress_iter, SCORES_100);
-    run_benchmark(500, stress_iter, SCORES_500);
+    bool tail = cfg.tail_samples > 0;
+    run_benchmark(100, tail ? cfg.tail_samples : stress_iter, SCORES_100, tail);
+    run_benchmark(500, tail ? cfg.tail_samples : stress_iter, SCORES_500, tail);
 }
 
 void run_leak_tests() {
     if (!cfg.use_valgrind) {
-        cout << WARN << " Valgrind disabled, skipping leak tests\n";
+        pool.ordered([] { cout << WARN << " Valgrind disabled, skipping leak tests\n"; });
         return;
     }
     
     print_header("MEMORY LEAK TESTS");
     
+    // One valgrind run; `highlight` colors the leaked byte count
+    auto leak_case = [](const string& name, const vector<string>& args,
+                        const string& trace_name, bool highlight) {
+        auto r = make_shared<ExecResult>();
+        pool.submit([=] { *r = run_push_swap(args, true); }, [=] {
+            string status = r->has_leaks ? LEAK : PASS;
+            if (r->has_leaks) {
+                stats.leaks++;
+                log_trace(trace_name, args, to_string(r->leaked_bytes) + " bytes leaked" + leak_report(*r));
+            }
+            string bytes = to_string(r->leaked_bytes) + " bytes";
+            report_test(name, "Memory Leak", !r->has_leaks, r->has_leaks ? bytes + " leaked" : "", *r);
+            print_result(name, status, r->has_leaks ? (highlight ? RED + bytes + RST : bytes) : "");
+        }, valgrind_job(true, args.size()));
+    };
+    
     print_subheader("Error Cases - Overflow in Middle of Valid List (CRITICAL!)");
     
     // CRITICAL: These test cases have valid numbers BEFORE the error
@@ -1433,13 +4029,7 @@ void run_leak_tests() {
     };
     
     for (const auto& tc : overflow_middle_cases) {
-        ExecResult r = run_push_swap(tc.second, true);
-        string status = r.has_leaks ? LEAK : PASS;
-        if (r.has_leaks) {
-            stats.leaks++;
-            log_trace("LEAK: " + tc.first, tc.second, to_string(r.leaked_bytes) + " bytes leaked");
-        }
-        print_result(tc.first, status, r.has_leaks ? RED + to_string(r.leaked_bytes) + " bytes" + RST : "");
+        leak_case(tc.first, tc.second, "LEAK: " + tc.first, true);
     }
     
     print_subheader("Error Cases - Invalid Char After Valid Numbers");
@@ -1456,13 +4046,7 @@ void run_leak_tests() {
     };
     
     for (const auto& tc : invalid_char_middle_cases) {
-        ExecResult r = run_push_swap(tc.second, true);
-        string status = r.has_leaks ? LEAK : PASS;
-        if (r.has_leaks) {
-            stats.leaks++;
-            log_trace("LEAK: " + tc.first, tc.second, to_string(r.leaked_bytes) + " bytes leaked");
-        }
-        print_result(tc.first, status, r.has_leaks ? RED + to_string(r.leaked_bytes) + " bytes" + RST : "");
+        leak_case(tc.first, tc.second, "LEAK: " + tc.first, true);
     }
     
     print_subheader("Error Cases - Duplicate After Allocation");
@@ -1479,13 +4063,7 @@ void run_leak_tests() {
     };
     
     for (const auto& tc : dup_after_alloc_cases) {
-        ExecResult r = run_push_swap(tc.second, true);
-        string status = r.has_leaks ? LEAK : PASS;
-        if (r.has_leaks) {
-            stats.leaks++;
-            log_trace("LEAK: " + tc.first, tc.second, to_string(r.leaked_bytes) + " bytes leaked");
-        }
-        print_result(tc.first, status, r.has_leaks ? RED + to_string(r.leaked_bytes) + " bytes" + RST : "");
+        leak_case(tc.first, tc.second, "LEAK: " + tc.first, true);
     }
     
     print_subheader("Error Cases - Sign Errors After Allocation");
@@ -1502,13 +4080,7 @@ void run_leak_tests() {
     };
     
     for (const auto& tc : sign_error_cases) {
-        ExecResult r = run_push_swap(tc.second, true);
-        string status = r.has_leaks ? LEAK : PASS;
-        if (r.has_leaks) {
-            stats.leaks++;
-            log_trace("LEAK: " + tc.first, tc.second, to_string(r.leaked_bytes) + " bytes leaked");
-        }
-        print_result(tc.first, status, r.has_leaks ? RED + to_string(r.leaked_bytes) + " bytes" + RST : "");
+        leak_case(tc.first, tc.second, "LEAK: " + tc.first, true);
     }
     
     print_subheader("Error Cases - Basic (no prior allocation)");
@@ -1533,13 +4105,7 @@ void run_leak_tests() {
     };
     
     for (const auto& tc : leak_cases) {
-        ExecResult r = run_push_swap(tc.second, true);
-        string status = r.has_leaks ? LEAK : PASS;
-        if (r.has_leaks) {
-            stats.leaks++;
-            log_trace("Leak: " + tc.first, tc.second, to_string(r.leaked_bytes) + " bytes leaked");
-        }
-        print_result(tc.first, status, r.has_leaks ? to_string(r.leaked_bytes) + " bytes" : "");
+        leak_case(tc.first, tc.second, "Leak: " + tc.first, false);
     }
     
     print_subheader("Quoted String Errors (single arg with spaces - split leak test)");
@@ -1561,13 +4127,7 @@ void run_leak_tests() {
     };
     
     for (const auto& tc : quoted_leak_cases) {
-        ExecResult r = run_push_swap(tc.second, true);
-        string status = r.has_leaks ? LEAK : PASS;
-        if (r.has_leaks) {
-            stats.leaks++;
-            log_trace("LEAK: " + tc.first, tc.second, to_string(r.leaked_bytes) + " bytes leaked");
-        }
-        print_result(tc.first, status, r.has_leaks ? RED + to_string(r.leaked_bytes) + " bytes" + RST : "");
+        leak_case(tc.first, tc.second, "LEAK: " + tc.first, true);
     }
     
     print_subheader("Valid Cases (must not leak)");
@@ -1583,35 +4143,23 @@ void run_leak_tests() {
     for (const auto& tc : valid_leak_cases) {
         vector<string> args;
         for (int n : tc.second) args.push_back(to_string(n));
-        ExecResult r = run_push_swap(args, true);
-        string status = r.has_leaks ? LEAK : PASS;
-        if (r.has_leaks) {
-            stats.leaks++;
-            log_trace("Leak: " + tc.first, args, to_string(r.leaked_bytes) + " bytes leaked");
-        }
-        print_result(tc.first, status, r.has_leaks ? to_string(r.leaked_bytes) + " bytes" : "");
+        leak_case(tc.first, args, "Leak: " + tc.first, false);
     }
     
     print_subheader("Large Allocations (stress test)");
     
     for (int n : {100, 500, 1000}) {
-        auto nums = generate_unique_random(n, -100000, 100000);
+        auto nums = generate_unique_random(n, -100000, 100000, test_seed("Leak: size " + to_string(n)));
         vector<string> args;
         for (int num : nums) args.push_back(to_string(num));
         
-        ExecResult r = run_push_swap(args, true);
-        string status = r.has_leaks ? LEAK : PASS;
-        if (r.has_leaks) {
-            stats.leaks++;
-            log_trace("Leak: size " + to_string(n), args, to_string(r.leaked_bytes) + " bytes leaked");
-        }
-        print_result("Size " + to_string(n), status, r.has_leaks ? to_string(r.leaked_bytes) + " bytes" : "");
+        leak_case("Size " + to_string(n), args, "Leak: size " + to_string(n), false);
     }
 }
 
 void run_checker_tests() {
     if (cfg.checker.empty()) {
-        cout << WARN << " No checker specified, skipping checker tests\n";
+        pool.ordered([] { cout << WARN << " No checker specified, skipping checker tests\n"; });
         return;
     }
     
@@ -1621,38 +4169,41 @@ void run_checker_tests() {
     
     // Test checker with known sequences
     auto test_checker = [](const string& name, const vector<int>& nums, 
-                          const string& instructions, bool expect_ok) {
+                          const InputSource& instructions, bool expect_ok) {
         vector<string> args;
         for (int n : nums) args.push_back(to_string(n));
         
-        ExecResult r = run_checker(args, instructions);
-        
-        // Check for crash first
-        if (r.signal_num != 0) {
+        auto r = make_shared<ExecResult>();
+        pool.submit([=] { *r = run_checker(args, instructions); }, [=] {
+            // Check for crash first
+            if (r->signal_num != 0) {
+                checker_stats.total++;
+                checker_stats.failed++;
+                checker_stats.crashes++;
+                checker_stats.failed_tests.push_back(name + " (crash)");
+                report_test(name, "Checker Test", false, "Crashed", *r);
+                print_result(name, SEGV, expect_ok ? "(expect OK)" : "(expect KO)");
+                return;
+            }
+            
+            bool got_ok = (r->stdout_data.find("OK") != string::npos);
+            bool got_ko = (r->stdout_data.find("KO") != string::npos);
+            
+            bool passed = (expect_ok && got_ok) || (!expect_ok && got_ko);
+            string status = passed ? PASS : FAIL;
+            
             checker_stats.total++;
-            checker_stats.failed++;
-            checker_stats.crashes++;
-            checker_stats.failed_tests.push_back(name + " (crash)");
-            print_result(name, SEGV, expect_ok ? "(expect OK)" : "(expect KO)");
-            return;
-        }
-        
-        bool got_ok = (r.stdout_data.find("OK") != string::npos);
-        bool got_ko = (r.stdout_data.find("KO") != string::npos);
-        
-        bool passed = (expect_ok && got_ok) || (!expect_ok && got_ko);
-        string status = passed ? PASS : FAIL;
-        
-        checker_stats.total++;
-        if (passed) checker_stats.passed++;
-        else {
-            checker_stats.failed++;
-            checker_stats.failed_tests.push_back(name);
-            string reason = expect_ok ? "Expected OK but got KO or no response" : "Expected KO but got OK or no response";
-            log_error(name, "Checker Test", reason, args);
-        }
-        
-        print_result(name, status, expect_ok ? "(expect OK)" : "(expect KO)");
+            if (passed) checker_stats.passed++;
+            else {
+                checker_stats.failed++;
+                checker_stats.failed_tests.push_back(name);
+                string reason = expect_ok ? "Expected OK but got KO or no response" : "Expected KO but got OK or no response";
+                log_error(name, "Checker Test", reason, args);
+            }
+            report_test(name, "Checker Test", passed, passed ? "" : expect_ok ? "Expected OK" : "Expected KO", *r);
+            
+            print_result(name, status, expect_ok ? "(expect OK)" : "(expect KO)");
+        });
     };
     
     // Already sorted - no ops should be OK
@@ -1669,6 +4220,16 @@ void run_checker_tests() {
     test_checker("3 2 1 -> ra sa", {3, 2, 1}, "ra\nsa\n", true);  // This sorts 3 2 1 to 1 2 3
     test_checker("3 2 1 -> sa ra (wrong)", {3, 2, 1}, "sa\nra\n", false);  // Wrong order, doesn't sort
     
+    // Far more input than a pipe holds, streamed while the checker reads.
+    // 1M rotations of 100 numbers is 10000 full turns: still sorted.
+    vector<int> hundred(100);
+    iota(hundred.begin(), hundred.end(), 1);
+    auto rotations = make_shared<int>(0);
+    test_checker("1..100 -> 1M x ra (streamed)", hundred, InputSource::from_generator([rotations](string& chunk) {
+        for (int i = 0; i < 4096 && *rotations < 1000000; ++i, ++*rotations) chunk += "ra\n";
+        return *rotations < 1000000;
+    }), true);
+    
     print_subheader("Invalid Instructions (should print Error)");
     
     auto test_checker_error = [](const string& name, const vector<int>& nums, 
@@ -1676,30 +4237,33 @@ void run_checker_tests() {
         vector<string> args;
         for (int n : nums) args.push_back(to_string(n));
         
-        ExecResult r = run_checker(args, instructions);
-        
-        // Check for crash first
-        if (r.signal_num != 0) {
+        auto r = make_shared<ExecResult>();
+        pool.submit([=] { *r = run_checker(args, instructions); }, [=] {
+            // Check for crash first
+            if (r->signal_num != 0) {
+                checker_stats.total++;
+                checker_stats.failed++;
+                checker_stats.crashes++;
+                checker_stats.failed_tests.push_back(name + " (crash)");
+                report_test(name, "Checker Error", false, "Crashed", *r);
+                print_result(name, SEGV);
+                return;
+            }
+            
+            bool has_error = (r->stderr_data.find("Error") != string::npos || 
+                             r->stdout_data.find("Error") != string::npos);
+            
+            string status = has_error ? PASS : FAIL;
             checker_stats.total++;
-            checker_stats.failed++;
-            checker_stats.crashes++;
-            checker_stats.failed_tests.push_back(name + " (crash)");
-            print_result(name, SEGV);
-            return;
-        }
-        
-        bool has_error = (r.stderr_data.find("Error") != string::npos || 
-                         r.stdout_data.find("Error") != string::npos);
-        
-        string status = has_error ? PASS : FAIL;
-        checker_stats.total++;
-        if (has_error) checker_stats.passed++;
-        else {
-            checker_stats.failed++;
-            checker_stats.failed_tests.push_back(name);
-        }
-        
-        print_result(name, status);
+            if (has_error) checker_stats.passed++;
+            else {
+                checker_stats.failed++;
+                checker_stats.failed_tests.push_back(name);
+            }
+            report_test(name, "Checker Error", has_error, has_error ? "" : "Expected 'Error'", *r);
+            
+            print_result(name, status);
+        });
     };
     
     test_checker_error("Invalid op 'swap'", {2, 1}, "swap\n");
@@ -1730,27 +4294,30 @@ void run_checker_tests() {
     print_subheader("Checker Error Handling");
     
     auto test_checker_parse_error = [](const string& name, const vector<string>& args) {
-        ExecResult r = execute_command({cfg.checker, args[0]});
-        
-        // Check for crash first
-        if (r.signal_num != 0) {
-            checker_stats.total++;
-            checker_stats.failed++;
-            checker_stats.crashes++;
-            checker_stats.failed_tests.push_back(name + " (crash)");
-            print_result(name, SEGV);
-            return;
-        }
-        
-        bool has_error = (r.stderr_data.find("Error") != string::npos);
-        string status = has_error ? PASS : FAIL;
-        checker_stats.total++;
-        if (has_error) checker_stats.passed++;
-        else {
-            checker_stats.failed++;
-            checker_stats.failed_tests.push_back(name);
-        }
-        print_result(name, status);
+        auto r = make_shared<ExecResult>();
+        pool.submit([=] { *r = execute_command({cfg.checker, args[0]}); }, [=] {
+            // Check for crash first
+            if (r->signal_num != 0) {
+                checker_stats.total++;
+                checker_stats.failed++;
+                checker_stats.crashes++;
+                checker_stats.failed_tests.push_back(name + " (crash)");
+                report_test(name, "Checker Error", false, "Crashed", *r);
+                print_result(name, SEGV);
+                return;
+            }
+            
+            bool has_error = (r->stderr_data.find("Error") != string::npos);
+            string status = has_error ? PASS : FAIL;
+            checker_stats.total++;
+            if (has_error) checker_stats.passed++;
+            else {
+                checker_stats.failed++;
+                checker_stats.failed_tests.push_back(name);
+            }
+            report_test(name, "Checker Error", has_error, has_error ? "" : "Expected 'Error'", *r);
+            print_result(name, status);
+        });
     };
     
     test_checker_parse_error("Duplicate args", {"1 1"});
@@ -1768,31 +4335,33 @@ void run_checker_tests() {
             vector<string> args;
             for (int n : nums) args.push_back(to_string(n));
             
-            ExecResult r = run_checker(args, instructions, true);
-            
-            bool has_leak = r.has_leaks || r.leaked_bytes > 0;
-            bool crashed = (r.signal_num != 0);
-            
-            string status;
-            if (crashed) {
-                status = SEGV;
-                checker_stats.crashes++;
-                checker_stats.failed++;
-                checker_stats.failed_tests.push_back(name + " (crash)");
-            } else if (has_leak) {
-                status = LEAK;
-                checker_stats.leaks++;
-                checker_stats.failed++;
-                checker_stats.failed_tests.push_back(name + " (leak)");
-            } else {
-                status = PASS;
-                checker_stats.passed++;
-            }
-            checker_stats.total++;
-            
-            string details = "";
-            if (has_leak) details = to_string(r.leaked_bytes) + " bytes leaked";
-            print_result(name, status, details);
+            auto r = make_shared<ExecResult>();
+            pool.submit([=] { *r = run_checker(args, instructions, true); }, [=] {
+                bool has_leak = r->has_leaks || r->leaked_bytes > 0;
+                bool crashed = (r->signal_num != 0);
+                
+                string status;
+                if (crashed) {
+                    status = SEGV;
+                    checker_stats.crashes++;
+                    checker_stats.failed++;
+                    checker_stats.failed_tests.push_back(name + " (crash)");
+                } else if (has_leak) {
+                    status = LEAK;
+                    checker_stats.leaks++;
+                    checker_stats.failed++;
+                    checker_stats.failed_tests.push_back(name + " (leak)");
+                } else {
+                    status = PASS;
+                    checker_stats.passed++;
+                }
+                checker_stats.total++;
+                
+                string details = "";
+                if (has_leak) details = to_string(r->leaked_bytes) + " bytes leaked";
+                report_test(name, "Checker Leak", !crashed && !has_leak, crashed ? "Crashed" : details, *r);
+                print_result(name, status, details);
+            }, valgrind_job(true, args.size()));
         };
         
         // Test valid cases
@@ -1800,41 +4369,37 @@ void run_checker_tests() {
         test_checker_leaks("Leak: simple swap", {2, 1}, "sa\n");
         test_checker_leaks("Leak: multiple ops", {3, 2, 1}, "ra\nsa\n");
         test_checker_leaks("Leak: all operations", {5, 4, 3, 2, 1}, "pb\npb\nra\nrb\nrr\nrra\nrrb\nrrr\nsa\nsb\nss\npa\npa\n");
-        test_checker_leaks("Leak: 100 elements", generate_unique_random(100, 1, 1000), "");
+        test_checker_leaks("Leak: 100 elements", generate_unique_random(100, 1, 1000, test_seed("Leak: 100 elements")), "");
         
         // Test error cases (should still not leak)
         auto test_checker_error_leaks = [](const string& name, const vector<string>& args) {
-            vector<string> cmd;
-            cmd = {"valgrind", "--leak-check=full", "--show-leak-kinds=all", 
-                   "--errors-for-leak-kinds=all", "--error-exitcode=42", 
-                   cfg.checker};
-            cmd.insert(cmd.end(), args.begin(), args.end());
-            
-            ExecResult r = execute_command(cmd, "", true);
-            
-            bool has_leak = r.has_leaks || r.leaked_bytes > 0;
-            bool crashed = (r.signal_num != 0);
-            
-            string status;
-            if (crashed) {
-                status = SEGV;
-                checker_stats.crashes++;
-                checker_stats.failed++;
-                checker_stats.failed_tests.push_back(name + " (crash)");
-            } else if (has_leak) {
-                status = LEAK;
-                checker_stats.leaks++;
-                checker_stats.failed++;
-                checker_stats.failed_tests.push_back(name + " (leak)");
-            } else {
-                status = PASS;
-                checker_stats.passed++;
-            }
-            checker_stats.total++;
-            
-            string details = "";
-            if (has_leak) details = to_string(r.leaked_bytes) + " bytes leaked";
-            print_result(name, status, details);
+            auto r = make_shared<ExecResult>();
+            pool.submit([=] { *r = run_checker(args, "", true); }, [=] {
+                bool has_leak = r->has_leaks || r->leaked_bytes > 0;
+                bool crashed = (r->signal_num != 0);
+                
+                string status;
+                if (crashed) {
+                    status = SEGV;
+                    checker_stats.crashes++;
+                    checker_stats.failed++;
+                    checker_stats.failed_tests.push_back(name + " (crash)");
+                } else if (has_leak) {
+                    status = LEAK;
+                    checker_stats.leaks++;
+                    checker_stats.failed++;
+                    checker_stats.failed_tests.push_back(name + " (leak)");
+                } else {
+                    status = PASS;
+                    checker_stats.passed++;
+                }
+                checker_stats.total++;
+                
+                string details = "";
+                if (has_leak) details = to_string(r->leaked_bytes) + " bytes leaked";
+                report_test(name, "Checker Leak", !crashed && !has_leak, crashed ? "Crashed" : details, *r);
+                print_result(name, status, details);
+            }, valgrind_job(true, args.size()));
         };
         
         // === OVERFLOW IN MIDDLE OF VALID LIST (CRITICAL!) ===
@@ -1904,32 +4469,46 @@ void run_stress_tests() {
     print_subheader("Rapid Fire (many small inputs)");
     
     int rapid_tests = cfg.stress_mode ? 100 : 20;
-    int failures = 0;
+    auto failures = make_shared<int>(0);
     
     for (int i = 0; i < rapid_tests; ++i) {
-        print_progress(i + 1, rapid_tests, "  Testing");
-        
         int size = (i % 10) + 1;  // 1-10 elements
-        auto nums = generate_unique_random(size, -1000, 1000);
+        uint64_t seed = test_seed("Rapid fire", i);
+        auto nums = generate_unique_random(size, -1000, 1000, seed);
         vector<string> args;
         for (int n : nums) args.push_back(to_string(n));
         
-        ExecResult r = run_push_swap(args, false);
-        
-        if (r.timed_out || r.signal_num != 0 || !validate_all_instructions(r.stdout_data)) {
-            failures++;
-            continue;
-        }
-        
-        if (!verify_sort(nums, r.stdout_data)) {
-            failures++;
-        }
+        auto ok = make_shared<bool>(false);
+        auto r = make_shared<ExecResult>();
+        pool.submit([=] {
+            StreamVerifier verifier(nums, cfg.early_kill);
+            verifier.keep_ops();
+            OutputSink sink = [&verifier](const char* data, size_t len) { return verifier.feed(data, len); };
+            *r = run_push_swap(args, false, &sink);
+            verifier.finish();
+            *ok = !r->timed_out && r->signal_num == 0 && !r->output_truncated && verifier.is_sorted();
+            if (!*ok) r->stdout_data = verifier.output();
+        }, [=] {
+            print_progress(i + 1, rapid_tests, "  Testing");
+            report_test("Rapid fire #" + to_string(i + 1), "Stress", *ok, *ok ? "" : "Crashed, timed out or not sorted",
+                        *r, 0, seed);
+            if (!*ok) {
+                (*failures)++;
+                int64_t offset;
+                uint32_t size;
+                log_error("Rapid fire #" + to_string(i + 1), "Stress", "Crashed, timed out or not sorted" +
+                          spill_output("Rapid fire #" + to_string(i + 1), *r, offset, size), args, seed);
+            }
+            *r = ExecResult();
+        });
     }
     
-    clear_line();
-    string status = (failures == 0) ? PASS : FAIL;
-    print_result("Rapid fire (" + to_string(rapid_tests) + " tests)", status, 
-                to_string(failures) + " failures");
+    pool.ordered([=] {
+        clear_line();
+        string status = (*failures == 0) ? PASS : FAIL;
+        print_result("Rapid fire (" + to_string(rapid_tests) + " tests)", status, 
+                    to_string(*failures) + " failures");
+    });
     
     print_subheader("Edge Value Combinations");
     
@@ -1943,7 +4522,7 @@ void run_stress_tests() {
     
     for (const auto& tc : edge_cases) {
         auto r = test_sort_case(tc.first, tc.second);
-        print_result(tc.first, r.status, to_string(r.instruction_count) + " ops");
+        print_result(tc.first, r, true);
     }
 }
 
@@ -2012,7 +4591,7 @@ void generate_html_report() {
         f << R"(
     <h2>📈 Performance Results</h2>
     <table>
-        <tr><th>Size</th><th>Min</th><th>Max</th><th>Average</th><th>Tests</th></tr>
+        <tr><th>Size</th><th>Min</th><th>Max</th><th>Average</th><th>Tests</th><th>CPU / run</th><th>Peak RSS</th><th>Faults / run (minor/major)</th><th>Switches / run (vol/invol)</th></tr>
 )";
         for (const auto& [size, results] : stats.perf_results) {
             if (!results.empty()) {
@@ -2020,7 +4599,17 @@ void generate_html_report() {
                 int max_v = *max_element(results.begin(), results.end());
                 int avg = accumulate(results.begin(), results.end(), 0) / results.size();
                 f << "        <tr><td>" << size << "</td><td>" << min_v << "</td><td>" 
-                  << max_v << "</td><td>" << avg << "</td><td>" << results.size() << "</td></tr>\n";
+                  << max_v << "</td><td>" << avg << "</td><td>" << results.size() << "</td>";
+                const UsageTotals& u = stats.perf_usage[size];
+                if (u.runs > 0) {
+                    f << fixed << setprecision(2) << "<td>" << (u.user_ms + u.sys_ms) / u.runs << " ms</td><td>"
+                      << (u.max_rss_bound ? "≤ " : "") << format_bytes(u.max_rss) << "</td>" << setprecision(0) << "<td>"
+                      << (double)u.minor_faults / u.runs << " / " << (double)u.major_faults / u.runs << "</td><td>"
+                      << (double)u.vol_switches / u.runs << " / " << (double)u.invol_switches / u.runs << "</td>";
+                } else {
+                    f << "<td>-</td><td>-</td><td>-</td><td>-</td>";
+                }
+                f << "</tr>\n";
             }
         }
         f << "    </table>\n";
@@ -2037,6 +4626,22 @@ void generate_html_report() {
         }
         f << "    </ul>\n";
     }
+    
+    // Their outputs, read back from the spill file (first 8 KB each)
+    bool any_spilled = any_of(all_results.begin(), all_results.end(),
+                              [](const ResultRecord& r) { return r.spill_offset >= 0; });
+    if (any_spilled) {
+        f << R"(
+    <h2>📄 Failed Test Output</h2>
+)";
+        for (const auto& r : all_results) {
+            if (r.spill_offset < 0) continue;
+            string out = spill.load(r.spill_offset, min(r.spill_size, 8192u));
+            if (out.size() < r.spill_size) out += "\n... (" + to_string(r.spill_size) + " bytes in " + cfg.spill_file + ")";
+            f << "    <details><summary>" << xml_escape(r.name) << " <span class=\"fail\">" << xml_escape(r.details)
+              << "</span></summary><pre>" << xml_escape(out) << "</pre></details>\n";
+        }
+    }
 
     f << R"(
 </body>
@@ -2046,6 +4651,639 @@ void generate_html_report() {
     cout << "\n" << GRN << "HTML report generated: " << cfg.html_file << RST << "\n";
 }
 
+// ==================================================================================
+// Spawn Benchmark
+// ==================================================================================
+
+// Launch rate of each backend on a trivial push_swap run, first with the
+// tester as it is and then holding a large touched heap, which is where
+// fork() has to copy page tables and posix_spawn() doesn't.
+void run_spawn_benchmark(int count) {
+    print_header("SPAWN BENCHMARK");
+    
+    auto measure = [count](bool use_fork) {
+        cfg.use_fork = use_fork;
+        auto start = chrono::high_resolution_clock::now();
+        int failed = 0;
+        for (int i = 0; i < count; ++i) {
+            if (run_push_swap({"2", "1"}, false, nullptr, true).exit_code != 0) failed++;
+        }
+        double secs = chrono::duration<double>(chrono::high_resolution_clock::now() - start).count();
+        if (failed > 0) cout << "  " << WARN << " " << failed << " runs failed\n";
+        return count / secs;
+    };
+    
+    bool saved = cfg.use_fork;
+    vector<char> ballast;
+    for (size_t heap : {(size_t)0, (size_t)512 << 20}) {
+        ballast.assign(heap, 1);
+        print_subheader("Extra tester heap: " + format_bytes(heap));
+        double fork_rate = measure(true);
+        double spawn_rate = measure(false);
+        ostringstream out;
+        out << fixed << right << setprecision(0);
+        out << "  fork + execvp   " << setw(8) << fork_rate << " spawns/sec\n";
+        out << "  posix_spawn     " << setw(8) << spawn_rate << " spawns/sec  "
+            << GRY << "(" << setprecision(2) << spawn_rate / fork_rate << "x)" << RST << "\n";
+        cout << out.str();
+    }
+    cfg.use_fork = saved;
+}
+
+// ==================================================================================
+// Simulator Benchmark
+// ==================================================================================
+
+// Runs the same random op stream through the deque simulator and the ring
+// simulator on an n-element input, checks they agree and reports ops/sec.
+void run_sim_benchmark(int n) {
+    print_header("SIMULATOR BENCHMARK");
+    
+    auto nums = generate_unique_random(n, INT_MIN, INT_MAX, 42);
+    vector<int> sorted_vals(nums);
+    sort(sorted_vals.begin(), sorted_vals.end());
+    vector<uint32_t> rank(n);
+    for (int i = 0; i < n; ++i) {
+        rank[i] = (uint32_t)(lower_bound(sorted_vals.begin(), sorted_vals.end(), nums[i]) - sorted_vals.begin());
+    }
+    
+    // A real sort's output: binary radix on the ranks (pb/ra per bit, then
+    // pa everything back), replayed from the start until ~20M ops
+    vector<uint8_t> radix;
+    for (int bit = 0; (n - 1) >> bit; ++bit) {
+        int pushed = 0;
+        for (int i = 0; i < n; ++i) {
+            bool one = (rank[i] >> bit) & 1;
+            radix.push_back(one ? RA : PB);
+            pushed += !one;
+        }
+        radix.insert(radix.end(), pushed, PA);
+        stable_partition(rank.begin(), rank.end(), [bit](uint32_t r) { return !((r >> bit) & 1); });
+    }
+    
+    // Worst case for any dispatch: a random mix, mostly rotations and pushes
+    mt19937 gen(42);
+    const uint8_t mix[] = {RA, RA, RA, RRA, RRA, RB, RRB, RR, RRR, PA, PB, PB, PA, SA, SB, SS};
+    uniform_int_distribution<size_t> pick(0, sizeof(mix) - 1);
+    vector<uint8_t> random_ops(20000000);
+    for (auto& op : random_ops) op = mix[pick(gen)];
+    size_t radix_reps = max((size_t)1, random_ops.size() / max((size_t)1, radix.size()));
+    
+    auto seconds_since = [](chrono::high_resolution_clock::time_point t) {
+        return chrono::duration<double>(chrono::high_resolution_clock::now() - t).count();
+    };
+    auto ranks = [&](const deque<int>& d) {
+        vector<uint32_t> out;
+        for (int v : d) out.push_back((uint32_t)(lower_bound(sorted_vals.begin(), sorted_vals.end(), v) - sorted_vals.begin()));
+        return out;
+    };
+    
+    for (auto* stream : {&radix, &random_ops}) {
+        const vector<uint8_t>& ops = *stream;
+        size_t reps = (stream == &radix) ? radix_reps : 1;
+        size_t total = ops.size() * reps;
+        string label = (stream == &radix) ? "radix sort output x" + to_string(reps) : "random ops";
+        
+        // Setup (the ring's includes rank compression) is timed apart from
+        // running the ops and the final check
+        StackSimulator deq;
+        RingSimulator ring;
+        bool deq_sorted = false, ring_sorted = false;
+        double deq_init = 0, deq_secs = 0, ring_init = 0, ring_secs = 0;
+        for (size_t r = 0; r < reps; ++r) {
+            auto t0 = chrono::high_resolution_clock::now();
+            deq.init(nums);
+            deq_init += seconds_since(t0);
+            t0 = chrono::high_resolution_clock::now();
+            deq.execute_all(ops);
+            deq_sorted = deq.is_sorted();
+            deq_secs += seconds_since(t0);
+            
+            t0 = chrono::high_resolution_clock::now();
+            ring.init(nums);
+            ring_init += seconds_since(t0);
+            t0 = chrono::high_resolution_clock::now();
+            ring.execute_all(ops);
+            ring_sorted = ring.is_sorted();
+            ring_secs += seconds_since(t0);
+        }
+        
+        // Same final stacks, compared as ranks
+        bool same = ranks(deq.a) == ring.stack_a() && ranks(deq.b) == ring.stack_b() && deq_sorted == ring_sorted;
+        
+        ostringstream title;
+        title << n << " numbers, " << fixed << setprecision(1) << total / 1e6 << "M ops (" << label << ")";
+        print_subheader(title.str());
+        ostringstream out;
+        out << fixed << right;
+        out << "  deque simulator " << setprecision(1) << setw(8) << total / deq_secs / 1e6 << " Mops/sec"
+            << GRY << "  init " << setprecision(2) << setw(6) << deq_init * 1000 / reps << " ms" << RST << "\n";
+        out << "  ring simulator  " << setprecision(1) << setw(8) << total / ring_secs / 1e6 << " Mops/sec"
+            << GRY << "  init " << setprecision(2) << setw(6) << ring_init * 1000 / reps << " ms" << RST
+            << "  (" << deq_secs / ring_secs << "x)\n";
+        cout << out.str();
+        print_result("Final stacks match", same ? PASS : FAIL, ring_sorted ? "sorted" : "not sorted");
+    }
+}
+
+// ==================================================================================
+// Scaling Benchmark
+// ==================================================================================
+
+// Least-squares fit of y = a + b * f(n) for one growth model
+struct ModelFit {
+    const char* name = "";
+    double a = 0, b = 0, rss = INFINITY;
+    
+    double at(double n) const { return a + b * model(name, n); }
+    
+    static double model(const string& name, double n) {
+        if (name == "n") return n;
+        if (name == "n log n") return n * log2(max(n, 2.0));
+        return n * n;
+    }
+};
+
+// Best of n, n log n and n² by residual sum of squares. A model needing a
+// negative slope doesn't describe growth and is skipped.
+ModelFit fit_growth(const vector<double>& ns, const vector<double>& ys) {
+    ModelFit best;
+    for (const char* name : {"n", "n log n", "n²"}) {
+        size_t k = ns.size();
+        double sx = 0, sy = 0, sxx = 0, sxy = 0;
+        for (size_t i = 0; i < k; ++i) {
+            double x = ModelFit::model(name, ns[i]);
+            sx += x;
+            sy += ys[i];
+            sxx += x * x;
+            sxy += x * ys[i];
+        }
+        double det = k * sxx - sx * sx;
+        if (k < 2 || det <= 0) continue;
+        ModelFit f;
+        f.name = name;
+        f.b = (k * sxy - sx * sy) / det;
+        f.a = (sy - f.b * sx) / k;
+        if (f.b <= 0) continue;
+        f.rss = 0;
+        for (size_t i = 0; i < k; ++i) f.rss += (ys[i] - f.at(ns[i])) * (ys[i] - f.at(ns[i]));
+        if (f.rss < best.rss) best = f;
+    }
+    return best;
+}
+
+// Local growth exponent: log-log slope over the last three points, after
+// taking off `base` (process startup for timings). 0 when it can't tell.
+double growth_exponent(const vector<double>& ns, const vector<double>& ys, double base) {
+    double sx = 0, sy = 0, sxx = 0, sxy = 0;
+    int k = 0;
+    for (size_t i = ns.size() >= 3 ? ns.size() - 3 : 0; i < ns.size(); ++i) {
+        if (ys[i] - base <= 0) return 0;
+        double x = log(ns[i]), y = log(ys[i] - base);
+        sx += x;
+        sy += y;
+        sxx += x * x;
+        sxy += x * y;
+        k++;
+    }
+    double det = k * sxx - sx * sx;
+    return (k < 3 || det <= 0) ? 0 : (k * sxy - sx * sy) / det;
+}
+
+// Sweeps n over 3 … 100000 (×√10 steps), one warmup and several timed runs
+// per size, one at a time so the timings don't compete with each other.
+// Runtime and op count are fitted against n, n log n and n², and growth
+// worse than n log n is flagged with where the fit crosses the timeout.
+void run_scaling_benchmark() {
+    print_header("SCALING BENCHMARK");
+    
+    const vector<int> sizes = {3, 10, 30, 100, 300, 1000, 3000, 10000, 30000, 100000};
+    int reps = cfg.quick_mode ? 3 : 5;
+    
+    struct Sample { double wall = 0, user = 0, sys = 0; int ops = 0; };
+    auto time_run = [](const vector<int>& nums, Sample& s) -> string {
+        vector<string> args;
+        for (int v : nums) args.push_back(to_string(v));
+        StreamVerifier verifier(nums);
+        OutputSink sink = [&verifier](const char* data, size_t len) { return verifier.feed(data, len); };
+        argv_arena.clear();
+        argv_arena.add(cfg.push_swap);
+        argv_arena.add(args);
+        ExecResult r = execute_argv(argv_arena, {}, LEAK_NONE, -1, nullptr, &sink);
+        verifier.finish();
+        s = {r.exec_time_ms, r.user_ms, r.sys_ms, verifier.count()};
+        if (r.timed_out) return "timed out after " + to_string(cfg.timeout_sec) + "s";
+        if (r.signal_num != 0) return "crashed (signal " + to_string(r.signal_num) + ")";
+        if (r.output_truncated) return "output exceeded " + format_bytes(cfg.max_output);
+        if (!verifier.is_valid()) return verifier.error();
+        if (!verifier.is_sorted()) return "not sorted";
+        return "";
+    };
+    
+    print_subheader("Runs (median of " + to_string(reps) + " after a warmup)");
+    pool.drain();
+    cout << GRY << "         n          ops     wall ms     user ms      sys ms" << RST << "\n";
+    
+    vector<double> ns, walls, ops;
+    string stopped;
+    for (int n : sizes) {
+        uint64_t seed = test_seed("Scaling " + to_string(n));
+        auto nums = generate_unique_random(n, -1000000, 1000000, seed);
+        vector<Sample> samples(reps);
+        Sample warmup;
+        string failure = time_run(nums, warmup);
+        for (int i = 0; i < reps && failure.empty(); ++i) failure = time_run(nums, samples[i]);
+        if (!failure.empty()) {
+            stopped = "n=" + to_string(n) + ": " + failure;
+            vector<string> args;
+            for (int v : nums) args.push_back(to_string(v));
+            log_error("Scaling n=" + to_string(n), "Scaling", failure, args, seed);
+            break;
+        }
+        
+        auto median = [&](double Sample::*field) {
+            vector<double> v;
+            for (const auto& s : samples) v.push_back(s.*field);
+            nth_element(v.begin(), v.begin() + v.size() / 2, v.end());
+            return v[v.size() / 2];
+        };
+        Sample m = {median(&Sample::wall), median(&Sample::user), median(&Sample::sys), samples[0].ops};
+        ostringstream row;
+        row << fixed << setprecision(2) << right << setw(10) << n << setw(13) << m.ops << setw(12) << m.wall
+            << setw(12) << m.user << setw(12) << m.sys;
+        cout << row.str() << "\n";
+        
+        ns.push_back(n);
+        walls.push_back(m.wall);
+        ops.push_back(m.ops);
+    }
+    if (!stopped.empty()) cout << "  " << RED << "Stopped at " << stopped << RST << "\n";
+    
+    print_subheader("Growth");
+    if (ns.size() < 3) {
+        cout << "  " << WARN << " Not enough sizes completed to fit a model\n";
+        return;
+    }
+    
+    // Growth past n log n shows as the n² model winning or a local exponent
+    // clearly above the ~1.1 that n log n has at these sizes
+    auto report = [&](const string& what, const vector<double>& ys, double base, const string& unit) {
+        ModelFit fit = fit_growth(ns, ys);
+        double exponent = growth_exponent(ns, ys, base);
+        bool superlinear = string(fit.name) == "n²" || exponent > 1.5;
+        ostringstream line;
+        line << "  " << left << setw(9) << what << right << "~ " << left << setw(8) << fit.name << right;
+        if (exponent > 0) line << fixed << setprecision(2) << GRY << " (local exponent " << exponent << ")" << RST;
+        cout << line.str() << "  " << (superlinear ? YEL "⚠ grows superlinearly" : GRN "✓ at most n log n") << RST << "\n";
+        
+        // Where the fitted runtime reaches the timeout
+        if (unit == "ms" && superlinear && fit.rss < INFINITY) {
+            double limit = cfg.timeout_sec * 1000.0;
+            for (double n = ns.back(); n < 1e8; n *= 1.05) {
+                if (fit.at(n) < limit) continue;
+                cout << "  " << GRY << "Projected to hit the " << cfg.timeout_sec << "s timeout near n=" << (long)n << RST << "\n";
+                break;
+            }
+        }
+    };
+    report("Runtime", walls, walls.front(), "ms");
+    report("Ops", ops, 0, "ops");
+}
+
+// ==================================================================================
+// Benchmark History
+// ==================================================================================
+
+// Each run that benchmarked appends one CSV row per size to the history file:
+//   run_id,unix_time,binary_sha256,seed,size,wall_ms,cpu_ms,ops
+// ops being every input's op count in order, ';'-separated, -1 where the run
+// failed. The inputs follow from the seed, so a run with the seed of an
+// older one gets the same inputs and compares against it pair by pair.
+struct HistoryRun {
+    string id;
+    long long time = 0;
+    string binary;
+    uint64_t seed = 0;
+    map<int, PerfRun> sizes;
+};
+
+string hex_string(const string& bytes) {
+    static const char digits[] = "0123456789abcdef";
+    string out;
+    for (unsigned char c : bytes) {
+        out += digits[c >> 4];
+        out += digits[c & 15];
+    }
+    return out;
+}
+
+vector<HistoryRun> load_history(const string& path) {
+    vector<HistoryRun> runs;
+    ifstream f(path);
+    string line;
+    while (getline(f, line)) {
+        if (line.empty() || line[0] == '#') continue;
+        vector<string> cols;
+        stringstream row(line);
+        string col;
+        while (getline(row, col, ',')) cols.push_back(col);
+        if (cols.size() == 7) cols.push_back("");  // no input recorded
+        if (cols.size() != 8) continue;
+        
+        // A run's rows are written together
+        if (runs.empty() || runs.back().id != cols[0]) {
+            runs.emplace_back();
+            runs.back().id = cols[0];
+            runs.back().time = atoll(cols[1].c_str());
+            runs.back().binary = cols[2];
+            runs.back().seed = strtoull(cols[3].c_str(), nullptr, 10);
+        }
+        PerfRun& size = runs.back().sizes[atoi(cols[4].c_str())];
+        size.wall_ms = atof(cols[5].c_str());
+        size.cpu_ms = atof(cols[6].c_str());
+        size.ops.clear();
+        stringstream ops(cols[7]);
+        while (getline(ops, col, ';')) size.ops.push_back(atoi(col.c_str()));
+    }
+    return runs;
+}
+
+// Appends this run, returns its id ("" if the file can't be written)
+string append_history(const string& path, const string& binary, const map<int, PerfRun>& sizes) {
+    time_t now = time(nullptr);
+    char stamp[32];
+    strftime(stamp, sizeof(stamp), "%Y%m%d-%H%M%S", localtime(&now));
+    
+    // Two runs within a second get a suffix
+    string id = stamp;
+    auto runs = load_history(path);
+    for (int k = 2; any_of(runs.begin(), runs.end(), [&](const HistoryRun& r) { return r.id == id; }); ++k) {
+        id = string(stamp) + "-" + to_string(k);
+    }
+    
+    struct stat st;
+    bool fresh = stat(path.c_str(), &st) != 0 || st.st_size == 0;
+    ofstream f(path, ios::app);
+    if (!f) return "";
+    if (fresh) f << "# run_id,unix_time,binary_sha256,seed,size,wall_ms,cpu_ms,ops\n";
+    for (const auto& [n, run] : sizes) {
+        ostringstream row;
+        row << id << "," << (long long)now << "," << binary << "," << cfg.seed << "," << n << ","
+            << fixed << setprecision(3) << run.wall_ms << "," << run.cpu_ms << ",";
+        for (size_t i = 0; i < run.ops.size(); ++i) row << (i ? ";" : "") << run.ops[i];
+        f << row.str() << "\n";
+    }
+    return f ? id : "";
+}
+
+// The run --baseline names: a run id in the history file, "last", or
+// another history file (its latest run). False with `error` set if none.
+bool find_baseline(const string& spec, HistoryRun& out, string& error) {
+    struct stat st;
+    bool is_file = spec != "last" && stat(spec.c_str(), &st) == 0 && S_ISREG(st.st_mode);
+    string path = is_file ? spec : cfg.history_file;
+    auto runs = load_history(path);
+    if (runs.empty()) {
+        error = "no benchmark history in " + path;
+        return false;
+    }
+    if (is_file || spec == "last") {
+        out = runs.back();
+        return true;
+    }
+    for (const auto& r : runs) {
+        if (r.id != spec) continue;
+        out = r;
+        return true;
+    }
+    error = "no run " + spec + " in " + path;
+    return false;
+}
+
+// Paired comparison of each size on the inputs both runs completed. A
+// size regresses when its mean op count rose past the tolerance and the
+// paired t-test says it isn't noise, when its P95 rose past the tolerance,
+// or when inputs the baseline sorted now fail. True if any size did.
+bool compare_to_baseline(const HistoryRun& base, const map<int, PerfRun>& current, const string& binary) {
+    print_header("BASELINE COMPARISON");
+    cout << "  " << GRY << "Baseline run " << RST << base.id << GRY << " ("
+         << (base.binary == binary ? "same binary" : "binary " + base.binary.substr(0, 12)) << "), tolerance "
+         << defaultfloat << cfg.tolerance_pct << "%" << RST << "\n\n";
+    
+    auto p95 = [](vector<int> v) { sort(v.begin(), v.end()); return v[(int)(v.size() * 0.95)]; };
+    double tol = cfg.tolerance_pct / 100;
+    int regressions = 0, compared = 0;
+    for (const auto& [n, now] : current) {
+        auto it = base.sizes.find(n);
+        if (it == base.sizes.end()) continue;
+        const PerfRun& old = it->second;
+        
+        vector<int> old_ops, new_ops;
+        vector<double> diffs;
+        int new_failures = 0;
+        for (size_t i = 0; i < min(old.ops.size(), now.ops.size()); ++i) {
+            if (old.ops[i] >= 0 && now.ops[i] < 0) new_failures++;
+            if (old.ops[i] < 0 || now.ops[i] < 0) continue;
+            old_ops.push_back(old.ops[i]);
+            new_ops.push_back(now.ops[i]);
+            diffs.push_back(now.ops[i] - old.ops[i]);
+        }
+        compared++;
+        
+        ostringstream line;
+        line << "  " << BLD << "Size " << left << setw(5) << n << RST << right;
+        if (diffs.empty()) {
+            line << YEL << "no inputs sorted by both runs" << RST;
+            if (new_failures > 0) {
+                line << RED << "  " << new_failures << " newly failing" << RST;
+                regressions++;
+            }
+            cout << line.str() << "\n";
+            continue;
+        }
+        
+        double old_mean = accumulate(old_ops.begin(), old_ops.end(), 0.0) / old_ops.size();
+        double new_mean = accumulate(new_ops.begin(), new_ops.end(), 0.0) / new_ops.size();
+        int old_p95 = p95(old_ops), new_p95 = p95(new_ops);
+        PairedTest t = paired_t_test(diffs);
+        auto rel = [](double from, double to) { return from > 0 ? (to - from) / from : (to > from ? INFINITY : 0); };
+        bool mean_worse = rel(old_mean, new_mean) > tol && t.p < 0.05;
+        bool p95_worse = rel(old_p95, new_p95) > tol;
+        
+        line << fixed << setprecision(1) << "mean " << old_mean << " → " << new_mean << " ("
+             << showpos << rel(old_mean, new_mean) * 100 << "%, Δ " << t.mean << " [" << t.lo << ", " << t.hi << "]"
+             << noshowpos << setprecision(4) << ", p=" << t.p << ")  P95 " << old_p95 << " → " << new_p95
+             << GRY << "  " << diffs.size() << " pairs" << RST;
+        if (old.cpu_ms > 0 && now.cpu_ms > 0) {
+            line << GRY << setprecision(2) << ", cpu " << old.cpu_ms << " → " << now.cpu_ms << " ms" << RST;
+        }
+        if (new_failures > 0) line << RED << "  " << new_failures << " newly failing" << RST;
+        
+        if (mean_worse || p95_worse || new_failures > 0) {
+            regressions++;
+            line << "  " << RED << BLD << "REGRESSED" << RST;
+        } else if (rel(old_mean, new_mean) < -tol && t.p < 0.05) {
+            line << "  " << GRN << "improved" << RST;
+        }
+        cout << line.str() << "\n";
+    }
+    
+    cout << "\n";
+    if (compared == 0) {
+        cout << "  " << YEL << "No benchmark sizes in common with the baseline" << RST << "\n";
+    } else if (regressions > 0) {
+        cout << "  " << RED << BLD << "✗ " << regressions << " size" << (regressions > 1 ? "s" : "")
+             << " regressed against " << base.id << RST << "\n";
+    } else {
+        cout << "  " << GRN << "✓ No regression against " << base.id << RST << "\n";
+    }
+    return regressions > 0;
+}
+
+// ==================================================================================
+// A/B Comparison
+// ==================================================================================
+
+// Runs two push_swap builds on the benchmark inputs (same seeds as
+// run_benchmark) and compares them input by input: the paired difference
+// with a t-test, and wins/losses with a sign test, which doesn't mind how
+// skewed the differences are. Both runs of an input are queued together so
+// they go side by side with -j.
+void run_comparison(const string& a, const string& b) {
+    print_header("A/B COMPARISON");
+    const vector<string> progs = {a, b};
+    const char* labels[2] = {"A", "B"};
+    pool.ordered([=] {
+        cout << "  " << BLD << "A" << RST << "  " << a << "\n";
+        cout << "  " << BLD << "B" << RST << "  " << b << "\n";
+    });
+    
+    auto compare_size = [&](int n, int iterations, const vector<Threshold>& thresholds) {
+        struct Side { vector<int> ops; double wall_ms = 0; int failures = 0; };
+        struct Tally { Side side[2]; vector<double> diffs; int wins_a = 0, wins_b = 0, ties = 0; };
+        auto tally = make_shared<Tally>();
+        print_subheader("Size " + to_string(n) + " (" + to_string(iterations) + " inputs)");
+        
+        for (int i = 0; i < iterations; ++i) {
+            uint64_t seed = test_seed("Perf " + to_string(n), i);
+            auto nums = generate_unique_random(n, -1000000, 1000000, seed);
+            vector<string> args;
+            for (int num : nums) args.push_back(to_string(num));
+            
+            struct Run { ExecResult r; int ops = 0; string failure; };
+            struct Pair { Run run[2]; };
+            auto pair = make_shared<Pair>();
+            
+            for (int s = 0; s < 2; ++s) {
+                auto work = [=] {
+                    StreamVerifier verifier(nums);
+                    OutputSink sink = [&verifier](const char* data, size_t len) { return verifier.feed(data, len); };
+                    Run& run = pair->run[s];
+                    run.r = run_program(progs[s], args, {}, false, &sink, true);
+                    verifier.finish();
+                    run.ops = verifier.count();
+                    if (run.r.timed_out) run.failure = "timed out";
+                    else if (run.r.signal_num != 0) run.failure = "crashed (signal " + to_string(run.r.signal_num) + ")";
+                    else if (run.r.output_truncated) run.failure = "output exceeded " + format_bytes(cfg.max_output);
+                    else if (!verifier.is_valid()) run.failure = verifier.error();
+                    else if (!verifier.is_sorted()) run.failure = "not sorted";
+                };
+                // A's run has no commit: B's comes after it and tallies both
+                if (s == 0) {
+                    pool.submit(work);
+                    continue;
+                }
+                pool.submit(work, [=] {
+                    print_progress(i + 1, iterations, "  Testing");
+                    for (int k = 0; k < 2; ++k) {
+                        const Run& run = pair->run[k];
+                        Side& side = tally->side[k];
+                        if (!run.failure.empty()) {
+                            side.failures++;
+                            log_error(string("Compare ") + labels[k] + " " + to_string(n) + " #" + to_string(i + 1),
+                                      "Comparison", progs[k] + ": " + run.failure + usage_report(run.r), args, seed);
+                            continue;
+                        }
+                        side.ops.push_back(run.ops);
+                        side.wall_ms += run.r.exec_time_ms;
+                    }
+                    if (!pair->run[0].failure.empty() || !pair->run[1].failure.empty()) return;
+                    int diff = pair->run[1].ops - pair->run[0].ops;
+                    tally->diffs.push_back(diff);
+                    if (diff > 0) tally->wins_a++;
+                    else if (diff < 0) tally->wins_b++;
+                    else tally->ties++;
+                });
+            }
+        }
+        
+        pool.ordered([=] {
+            clear_line();
+            
+            // One row per binary: distribution, failures and grade by mean
+            cout << GRY << "         mean   median      P95      max   fails   grade" << RST << "\n";
+            for (int k = 0; k < 2; ++k) {
+                vector<int> ops = tally->side[k].ops;
+                ostringstream row;
+                row << "  " << BLD << labels[k] << RST;
+                if (ops.empty()) {
+                    row << RED << "  all runs failed" << RST;
+                    cout << row.str() << "\n";
+                    continue;
+                }
+                sort(ops.begin(), ops.end());
+                double mean = accumulate(ops.begin(), ops.end(), 0.0) / ops.size();
+                int avg = (int)(mean);
+                row << fixed << setprecision(1) << setw(11) << mean << setw(9) << ops[ops.size() / 2]
+                    << setw(9) << ops[(int)(ops.size() * 0.95)] << setw(9) << ops.back()
+                    << (tally->side[k].failures > 0 ? RED : "") << setw(8) << tally->side[k].failures << RST
+                    << "   " << (get_score(avg, thresholds) >= 4 ? GRN : YEL) << get_grade(avg, thresholds) << RST;
+                
+                // Share of inputs within each limit of the table
+                row << GRY << "  ";
+                for (const auto& t : thresholds) {
+                    if (t.limit == INT_MAX) continue;
+                    size_t in = upper_bound(ops.begin(), ops.end(), t.limit) - ops.begin();
+                    row << " ≤" << t.limit << " " << setprecision(0) << 100.0 * in / ops.size() << "%";
+                }
+                row << setprecision(2) << ", " << tally->side[k].wall_ms / ops.size() << " ms/run" << RST;
+                cout << row.str() << "\n";
+            }
+            
+            if (tally->diffs.empty()) {
+                cout << "  " << YEL << "No input sorted by both, nothing to compare" << RST << "\n";
+                return;
+            }
+            PairedTest t = paired_t_test(tally->diffs);
+            double sign_p = sign_test_p(tally->wins_a, tally->wins_b);
+            ostringstream diff;
+            diff << fixed << setprecision(1) << showpos << t.mean << " [" << t.lo << ", " << t.hi << "]"
+                 << noshowpos << setprecision(4) << ", paired t-test p=" << t.p;
+            cout << "  " << GRY << "B − A:   " << RST << diff.str() << GRY << " (" << t.n << " inputs)" << RST << "\n";
+            
+            ostringstream wins;
+            wins << fixed << setprecision(4) << "A " << tally->wins_a << ", B " << tally->wins_b << ", ties "
+                 << tally->ties << ", sign test p=" << sign_p;
+            cout << "  " << GRY << "Wins:    " << RST << wins.str() << "\n";
+            
+            cout << "  " << GRY << "Verdict: " << RST;
+            if (t.p < 0.05 && t.mean != 0) {
+                cout << GRN << BLD << (t.mean > 0 ? "A" : "B") << RST << GRN << " uses fewer ops" << RST << "\n";
+            } else {
+                cout << YEL << "no significant difference" << RST << "\n";
+            }
+        });
+    };
+    
+    // The graded sizes, as many inputs as the benchmarks
+    int quick_iter = cfg.quick_mode ? 10 : 50;
+    int stress_iter = cfg.stress_mode ? 100 : 50;
+    compare_size(3, quick_iter, SCORES_3);
+    compare_size(5, quick_iter, SCORES_5);
+    compare_size(100, stress_iter, SCORES_100);
+    compare_size(500, stress_iter, SCORES_500);
+}
+
 // ==================================================================================
 // Main
 // ==================================================================================
@@ -2088,10 +5326,45 @@ void print_usage(const char* prog) {
     cout << "  --stress          Extra stress tests\n";
     cout << "  --html            Generate HTML report\n";
     cout << "  --checker-only    Only test checker program\n";
+    cout << "  -j, --jobs N      Run N tests in parallel (N or 'auto')\n";
+    cout << "  --max-output SIZE Max bytes kept per child stream (default 64M)\n";
+    cout << "  --spawn MODE      Launch children with posix_spawn (default) or fork\n";
+    cout << "  --spawn-bench N   Time N launches per backend and exit\n";
+    cout << "  --sim-bench N     Compare stack simulators on N numbers and exit\n";
+    cout << "  --fork-server[=SO] Fork runs from a preloaded server (make forkserver)\n";
+    cout << "  --early-kill      Stop push_swap at an invalid op or past the 1/5 limit\n";
+    cout << "  --seed N          Reuse a run seed to regenerate the same inputs\n";
+    cout << "  --leak-sample P%|K Valgrind-check P% of benchmark runs, or the first K per size (default 10%)\n";
+    cout << "  --leak-engine E   Leak checker: valgrind (default) or shim (make leakshim)\n";
+    cout << "  --mem-budget SIZE Max projected RSS of parallel valgrind jobs (default half of RAM)\n";
+    cout << "  --cache-dir DIR   Result cache location (default .ps_tester_cache)\n";
+    cout << "  --no-cache        Don't reuse or save results across runs\n";
+    cout << "  --adaptive[=STAT] Benchmark until the grade's 95% CI is settled (mean, p90, ...)\n";
+    cout << "  --max-iter N      Max adaptive benchmark runs per size (default 1000)\n";
+    cout << "  --tail-risk[=N]   Run N (default 5000) inputs of 100/500, report P(ops > limit)\n";
+    cout << "  --trials K        Inputs per evaluation for the tail-risk pass chance (default 5)\n";
+    cout << "  --scaling         Time runs from 3 to 100000 numbers, fit n / n log n / n² and exit\n";
+    cout << "  --json FILE       Stream one JSON record per test to FILE\n";
+    cout << "  --junit FILE      Stream JUnit XML results to FILE\n";
+    cout << "  --history FILE    Benchmark history file (default .ps_tester_history.csv)\n";
+    cout << "  --no-history      Don't record this run in the history\n";
+    cout << "  --baseline RUN    Compare against a past run (id, 'last' or a history file) on its inputs\n";
+    cout << "  --tolerance PCT   Mean/P95 op increase allowed against the baseline (default 1%)\n";
+    cout << "  --compare A B     Run push_swap builds A and B on the same inputs, compare ops and exit\n";
     cout << "  --verbose         Verbose output\n";
     cout << "  --help            Show this help\n";
 }
 
+// Directory of the tester binary, where the shims get built
+string tester_dir(const char* argv0) {
+    string self = argv0;
+    char exe[PATH_MAX];
+    ssize_t n = readlink("/proc/self/exe", exe, sizeof(exe) - 1);
+    if (n > 0) self.assign(exe, n);
+    size_t slash = self.rfind('/');
+    return slash == string::npos ? string(".") : self.substr(0, slash);
+}
+
 int main(int argc, char** argv) {
     print_banner();
     
@@ -2102,6 +5375,11 @@ int main(int argc, char** argv) {
     
     // Parse arguments
     vector<string> positional;
+    int spawn_bench = 0;
+    bool scaling = false;
+    vector<string> compare;
+    bool use_fork_server = false;
+    string leak_engine = "valgrind";
     for (int i = 1; i < argc; ++i) {
         string arg = argv[i];
         if (arg == "--no-valgrind") cfg.use_valgrind = false;
@@ -2111,9 +5389,132 @@ int main(int argc, char** argv) {
         else if (arg == "--checker-only") cfg.checker_only = true;
         else if (arg == "--verbose") cfg.verbose = true;
         else if (arg == "--help" || arg == "-h") { print_usage(argv[0]); return 0; }
+        else if (arg == "-j" || arg == "--jobs" || arg.rfind("-j", 0) == 0 || arg.rfind("--jobs=", 0) == 0) {
+            string val;
+            if (arg == "-j" || arg == "--jobs") {
+                if (i + 1 >= argc) { cerr << RED << "Error: " << arg << " needs a value\n" << RST; return 1; }
+                val = argv[++i];
+            } else {
+                val = arg.substr(arg[1] == 'j' ? 2 : 7);
+            }
+            if (val == "auto") cfg.jobs = max(1u, thread::hardware_concurrency());
+            else cfg.jobs = atoi(val.c_str());
+            if (cfg.jobs < 1) { cerr << RED << "Error: invalid job count: " << val << "\n" << RST; return 1; }
+        }
+        else if (arg == "--max-output" && i + 1 < argc) {
+            cfg.max_output = parse_size(argv[++i]);
+            if (cfg.max_output == 0) { cerr << RED << "Error: invalid size: " << argv[i] << "\n" << RST; return 1; }
+        }
+        else if (arg == "--no-cache") cfg.cache_dir.clear();
+        else if (arg == "--cache-dir" && i + 1 < argc) cfg.cache_dir = argv[++i];
+        else if (arg == "--adaptive" || arg.rfind("--adaptive=", 0) == 0) {
+            string stat = arg.size() > 11 ? arg.substr(11) : "mean";
+            char* end = nullptr;
+            long pct = (stat.size() > 1 && (stat[0] == 'p' || stat[0] == 'P')) ? strtol(stat.c_str() + 1, &end, 10) : 0;
+            if (stat == "mean") cfg.adaptive_q = -1;
+            else if (end && *end == '\0' && pct > 0 && pct < 100) cfg.adaptive_q = pct / 100.0;
+            else { cerr << RED << "Error: invalid adaptive statistic: " << stat << "\n" << RST; return 1; }
+        }
+        else if (arg == "--tail-risk" || arg.rfind("--tail-risk=", 0) == 0) {
+            cfg.tail_samples = arg.size() > 12 ? atoi(arg.c_str() + 12) : 5000;
+            if (cfg.tail_samples < 1) { cerr << RED << "Error: invalid sample count: " << arg.substr(12) << "\n" << RST; return 1; }
+        }
+        else if (arg == "--trials" && i + 1 < argc) {
+            cfg.eval_trials = atoi(argv[++i]);
+            if (cfg.eval_trials < 1) { cerr << RED << "Error: invalid trial count: " << argv[i] << "\n" << RST; return 1; }
+        }
+        else if (arg == "--max-iter" && i + 1 < argc) {
+            cfg.max_iterations = atoi(argv[++i]);
+            if (cfg.max_iterations < 10) { cerr << RED << "Error: --max-iter needs at least 10\n" << RST; return 1; }
+        }
+        else if (arg == "--mem-budget" && i + 1 < argc) {
+            cfg.mem_budget = parse_size(argv[++i]);
+            if (cfg.mem_budget == 0) { cerr << RED << "Error: invalid size: " << argv[i] << "\n" << RST; return 1; }
+        }
+        else if (arg == "--spawn" && i + 1 < argc) {
+            string mode = argv[++i];
+            if (mode != "fork" && mode != "posix_spawn") { cerr << RED << "Error: unknown spawn mode: " << mode << "\n" << RST; return 1; }
+            cfg.use_fork = (mode == "fork");
+        }
+        else if (arg == "--early-kill") cfg.early_kill = true;
+        else if (arg == "--leak-sample" && i + 1 < argc) {
+            string val = argv[++i];
+            char* end = nullptr;
+            double v = strtod(val.c_str(), &end);
+            bool pct = (*end == '%' && end[1] == '\0');
+            if (end == val.c_str() || (!pct && *end != '\0') || v < 0 || (pct && v > 100) || (!pct && v != (int)v)) {
+                cerr << RED << "Error: invalid leak sample: " << val << "\n" << RST;
+                return 1;
+            }
+            if (pct) {
+                cfg.leak_sample_pct = v;
+                cfg.leak_sample_first = -1;
+            } else {
+                cfg.leak_sample_first = (int)v;
+            }
+        }
+        else if (arg == "--seed" && i + 1 < argc) {
+            char* end = nullptr;
+            cfg.seed = strtoull(argv[++i], &end, 0);
+            if (*end != '\0' || cfg.seed == 0) { cerr << RED << "Error: invalid seed: " << argv[i] << "\n" << RST; return 1; }
+        }
+        else if (arg == "--leak-engine" || arg.rfind("--leak-engine=", 0) == 0) {
+            if (arg == "--leak-engine") {
+                if (i + 1 >= argc) { cerr << RED << "Error: " << arg << " needs a value\n" << RST; return 1; }
+                leak_engine = argv[++i];
+            } else {
+                leak_engine = arg.substr(14);
+            }
+            if (leak_engine != "valgrind" && leak_engine != "shim") {
+                cerr << RED << "Error: unknown leak engine: " << leak_engine << "\n" << RST;
+                return 1;
+            }
+        }
+        else if (arg == "--fork-server") use_fork_server = true;
+        else if (arg.rfind("--fork-server=", 0) == 0) {
+            use_fork_server = true;
+            cfg.fork_server = arg.substr(14);
+        }
+        else if (arg == "--sim-bench" && i + 1 < argc) {
+            int n = atoi(argv[++i]);
+            if (n < 1) { cerr << RED << "Error: invalid size: " << argv[i] << "\n" << RST; return 1; }
+            run_sim_benchmark(n);
+            return 0;
+        }
+        else if (arg == "--scaling") scaling = true;
+        else if (arg == "--compare" && i + 2 < argc) {
+            compare = {argv[i + 1], argv[i + 2]};
+            i += 2;
+        }
+        else if (arg == "--json" && i + 1 < argc) cfg.json_file = argv[++i];
+        else if (arg == "--junit" && i + 1 < argc) cfg.junit_file = argv[++i];
+        else if (arg == "--history" && i + 1 < argc) cfg.history_file = argv[++i];
+        else if (arg == "--no-history") cfg.record_history = false;
+        else if (arg == "--baseline" && i + 1 < argc) cfg.baseline = argv[++i];
+        else if (arg == "--tolerance" && i + 1 < argc) {
+            char* end = nullptr;
+            cfg.tolerance_pct = strtod(argv[++i], &end);
+            if (end == argv[i] || (*end != '\0' && strcmp(end, "%") != 0) || cfg.tolerance_pct < 0) {
+                cerr << RED << "Error: invalid tolerance: " << argv[i] << "\n" << RST;
+                return 1;
+            }
+        }
+        else if (arg == "--spawn-bench" && i + 1 < argc) {
+            spawn_bench = atoi(argv[++i]);
+            if (spawn_bench < 1) { cerr << RED << "Error: invalid spawn count: " << argv[i] << "\n" << RST; return 1; }
+        }
         else positional.push_back(arg);
     }
     
+    // With --compare, A stands in for push_swap
+    if (!compare.empty()) {
+        if (access(compare[1].c_str(), X_OK) != 0) {
+            cerr << RED << "Error: push_swap binary not found or not executable: " << compare[1] << "\n" << RST;
+            return 1;
+        }
+        positional.insert(positional.begin(), compare[0]);
+    }
+    
     if (positional.empty()) {
         cerr << RED << "Error: push_swap path required\n" << RST;
         return 1;
@@ -2136,25 +5537,140 @@ int main(int argc, char** argv) {
         }
     }
     
+    if (spawn_bench > 0) {
+        run_spawn_benchmark(spawn_bench);
+        return 0;
+    }
+    if (scaling) {
+        remove(cfg.errors_file.c_str());
+        logger.start();
+        run_scaling_benchmark();
+        logger.stop();
+        return 0;
+    }
+    
+    // The shim only sees dynamically linked programs: check it reports
+    // before trusting its silence
+    if (cfg.use_valgrind && leak_engine == "shim") {
+        char resolved[PATH_MAX];
+        string shim = tester_dir(argv[0]) + "/ps_leakshim.so";
+        if (!realpath(shim.c_str(), resolved)) {
+            cout << YEL << "⚠ Leak shim not found (" << shim << "), run 'make leakshim'. Using valgrind\n" << RST;
+        } else {
+            cfg.leak_shim = resolved;
+            leak_shim_env = preload_env(cfg.leak_shim, "PS_LEAKSHIM_FD", REPORT_FD);
+            for (auto& e : leak_shim_env) leak_shim_envp.push_back(&e[0]);
+            leak_shim_envp.push_back(nullptr);
+            if (run_push_swap({"2", "1"}, true).leak_summary.empty()) {
+                cout << YEL << "⚠ Leak shim could not attach to push_swap (static binary?), using valgrind\n" << RST;
+                cfg.leak_shim.clear();
+            }
+        }
+    }
+    
     // Check if valgrind is available
-    if (cfg.use_valgrind) {
+    if (cfg.use_valgrind && cfg.leak_shim.empty()) {
         ExecResult vg = execute_command({"valgrind", "--version"});
         if (vg.exit_code != 0) {
             cout << YEL << "⚠ Valgrind not found, disabling leak tests\n" << RST;
             cfg.use_valgrind = false;
         }
+        result_cache.valgrind_version = vg.stdout_data;
+    }
+    
+    // The shim sits next to the tester unless given; LD_PRELOAD wants a full path
+    if (use_fork_server) {
+        if (cfg.fork_server.empty()) cfg.fork_server = tester_dir(argv[0]) + "/ps_forkserver.so";
+        char resolved[PATH_MAX];
+        if (!realpath(cfg.fork_server.c_str(), resolved)) {
+            cout << YEL << "⚠ Fork server shim not found (" << cfg.fork_server << "), run 'make forkserver'\n" << RST;
+            cfg.fork_server.clear();
+        } else {
+            cfg.fork_server = resolved;
+            if (!fork_server_for(cfg.push_swap)) {
+                cout << YEL << "⚠ Fork server could not attach to push_swap, using normal spawns\n" << RST;
+                cfg.fork_server.clear();
+            }
+        }
+    }
+    
+    result_cache.dir = cfg.cache_dir;
+    result_cache.load();
+    
+    // The baseline's inputs come from its seed
+    HistoryRun baseline;
+    if (!cfg.baseline.empty()) {
+        string error;
+        if (!find_baseline(cfg.baseline, baseline, error)) {
+            cerr << RED << "Error: " << error << "\n" << RST;
+            return 1;
+        }
+        if (cfg.seed != 0 && cfg.seed != baseline.seed) {
+            cout << YEL << "⚠ --seed ignored, using the seed of baseline run " << baseline.id << "\n" << RST;
+        }
+        cfg.seed = baseline.seed;
+    }
+    
+    if (cfg.seed == 0) {
+        random_device rd;
+        do cfg.seed = ((uint64_t)rd() << 32) | rd(); while (cfg.seed == 0);
+    }
+    
+    if (!compare.empty()) {
+        cout << GRY << "Seed:      " << RST << cfg.seed << "\n";
+        cout << GRY << "Jobs:      " << RST << cfg.jobs << "\n";
+        remove(cfg.errors_file.c_str());
+        logger.start();
+        signal(SIGPIPE, SIG_IGN);
+        if (cfg.jobs > 1) pool.start(cfg.jobs);
+        run_comparison(compare[0], compare[1]);
+        pool.stop();
+        logger.stop();
+        result_cache.save();
+        return 0;
     }
     
     // Clear trace file and errors file
     remove(cfg.trace_file.c_str());
     remove(cfg.errors_file.c_str());
+    remove(cfg.spill_file.c_str());
+    logger.start();
+    if (!result_streams.open(cfg.json_file, cfg.junit_file)) {
+        cerr << RED << "Error: cannot write results: " << strerror(errno) << "\n" << RST;
+        return 1;
+    }
     
     cout << GRY << "Push_swap: " << RST << cfg.push_swap << "\n";
     if (!cfg.checker.empty()) cout << GRY << "Checker:   " << RST << cfg.checker << "\n";
-    cout << GRY << "Valgrind:  " << RST << (cfg.use_valgrind ? GRN "Enabled" : RED "Disabled") << RST << "\n";
+    cout << GRY << "Leaks:     " << RST;
+    if (!cfg.use_valgrind) cout << RED << "Disabled" << RST << "\n";
+    else cout << GRN << (cfg.leak_shim.empty() ? "valgrind" : "shim") << RST << "\n";
     cout << GRY << "Mode:      " << RST << (cfg.quick_mode ? "Quick" : (cfg.stress_mode ? "Stress" : "Normal")) << "\n";
+    if (cfg.adaptive_q != 0) {
+        cout << GRY << "Adaptive:  " << RST << stat_name(cfg.adaptive_q) << ", up to " << cfg.max_iterations << " runs per size\n";
+    }
+    cout << GRY << "Jobs:      " << RST << cfg.jobs << "\n";
+    
+    // Valgrind jobs are admitted by projected peak RSS, see MemoryGate
+    bool gated = cfg.jobs > 1 && cfg.use_valgrind && cfg.leak_shim.empty();
+    if (gated && cfg.mem_budget == 0) {
+        long pages = sysconf(_SC_PHYS_PAGES), page_size = sysconf(_SC_PAGESIZE);
+        if (pages > 0 && page_size > 0) cfg.mem_budget = (size_t)pages * page_size / 2;
+    }
+    if (gated && cfg.mem_budget > 0) {
+        pool.set_mem_budget(cfg.mem_budget);
+        cout << GRY << "Mem cap:   " << RST << format_bytes(cfg.mem_budget) << " for valgrind jobs\n";
+    }
+    cout << GRY << "Seed:      " << RST << cfg.seed << "\n";
+    if (!cfg.baseline.empty()) {
+        cout << GRY << "Baseline:  " << RST << baseline.id << GRY << " (tolerance " << cfg.tolerance_pct << "%)" << RST << "\n";
+    }
+    cout << GRY << "Spawn:     " << RST << (!cfg.fork_server.empty() ? "fork server" : (cfg.use_fork ? "fork" : "posix_spawn")) << "\n";
     
     auto start_time = chrono::high_resolution_clock::now();
+    // A child closing its stdin early must not kill the tester
+    signal(SIGPIPE, SIG_IGN);
+    if (cfg.jobs > 1) pool.start(cfg.jobs);
     
     // Run test suites
     if (!cfg.checker_only) {
@@ -2170,6 +5686,10 @@ int main(int argc, char** argv) {
         run_checker_tests();
     }
     
+    pool.stop();
+    logger.stop();
+    result_streams.close();
+    result_cache.save();
     auto end_time = chrono::high_resolution_clock::now();
     double elapsed = chrono::duration<double>(end_time - start_time).count();
     
@@ -2227,6 +5747,13 @@ int main(int argc, char** argv) {
     
     cout << "\n";
     cout << "  ⏱️  Time Elapsed:   " << fixed << setprecision(2) << elapsed << "s\n";
+    if (result_cache.lookups > 0 && !cfg.cache_dir.empty()) {
+        cout << "  💾 Cached runs:    " << result_cache.hits << "/" << result_cache.lookups
+             << GRY << " (" << cfg.cache_dir << ")" << RST << "\n";
+    }
+    if (result_cache.saved > 0) {
+        cout << "  ♻️  Repeats saved:  " << result_cache.saved << GRY << " (same input already run this session)" << RST << "\n";
+    }
     
     cout << "\n" << GRY << "Trace log: " << cfg.trace_file << RST << "\n";
     if (stats.failed > 0 || checker_stats.failed > 0) {
@@ -2237,6 +5764,14 @@ int main(int argc, char** argv) {
         generate_html_report();
     }
     
+    string binary = hex_string(result_cache.binary_hash(cfg.push_swap));
+    bool regressed = !cfg.baseline.empty() && compare_to_baseline(baseline, stats.perf_runs, binary);
+    if (cfg.record_history && !stats.perf_runs.empty()) {
+        string id = append_history(cfg.history_file, binary, stats.perf_runs);
+        if (id.empty()) cout << YEL << "⚠ Could not write benchmark history to " << cfg.history_file << RST << "\n";
+        else cout << "\n" << GRY << "History: run " << id << " in " << cfg.history_file << RST << "\n";
+    }
+    
     // Final message
     bool all_passed = (stats.failed == 0 && stats.leaks == 0 && stats.crashes == 0);
     bool checker_passed = cfg.checker.empty() || (checker_stats.failed == 0 && checker_stats.leaks == 0 && checker_stats.crashes == 0);
@@ -2249,5 +5784,6 @@ int main(int argc, char** argv) {
         cout << "\n" << BLD << RED << "⚠ Some tests failed. Check errors.txt for details." << RST << "\n\n";
     }
     
-    return (stats.failed > 0 || stats.crashes > 0) ? 1 : 0;
+    if (stats.failed > 0 || stats.crashes > 0) return 1;
+    return regressed ? 2 : 0;
 }